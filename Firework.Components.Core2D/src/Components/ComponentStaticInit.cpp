@@ -8,6 +8,7 @@
 #include <Core/PackageManager.h>
 #include <EntityComponentSystem/EngineEvent.h>
 #include <EntityComponentSystem/EntityManagement.h>
+#include <EntityComponentSystem/EntitySnapshot.h>
 #include <Friends/ShapeRenderer.h>
 #include <GL/Renderer.h>
 #include <PackageSystem/ExtensibleMarkupFile.h>
@@ -49,21 +50,59 @@ namespace
             PackageManager::addTextFileHandler<ExtensibleMarkupPackageFile>(L".xml");
             PackageManager::addTextFileHandler<ExtensibleMarkupPackageFile>(L".svg");
 
+            // Package files are referenced by path, and looked up again on restore.
+            EntitySnapshot::registerComponent<Text>("Firework.Text", [](const Text& text, SnapshotWriter& writer)
+            {
+                writer.write(text.active);
+                writer.write(text._font ? std::wstring_view(text._font->filePath) : std::wstring_view());
+                writer.write(text._fontSize);
+                writer.write(text._text);
+                writer.write(text._color.r);
+                writer.write(text._color.g);
+                writer.write(text._color.b);
+                writer.write(text._color.a);
+            }, [](Text& text, SnapshotReader& reader)
+            {
+                text.active = reader.read<bool>();
+                std::wstring fontPath = reader.readWString();
+                text._font = fontPath.empty() ? nullptr : std::dynamic_pointer_cast<TrueTypeFontPackageFile>(PackageManager::lookupFileByPath(fontPath));
+                if (!fontPath.empty() && !text._font)
+                    Debug::logWarn("Restored `Text` references font \"", fontPath, "\", which isn't loaded.");
+                text._fontSize = reader.read<float>();
+                text._text = reader.readU32String();
+                text._color.r = reader.read<uint8_t>();
+                text._color.g = reader.read<uint8_t>();
+                text._color.b = reader.read<uint8_t>();
+                text._color.a = reader.read<uint8_t>();
+                text.dirty = true;
+            });
+            EntitySnapshot::registerComponent<ScalableVectorGraphic>("Firework.ScalableVectorGraphic", [](const ScalableVectorGraphic& svg, SnapshotWriter& writer)
+            {
+                writer.write(svg.active);
+                writer.write(svg._svgFile ? std::wstring_view(svg._svgFile->filePath) : std::wstring_view());
+            }, [](ScalableVectorGraphic& svg, SnapshotReader& reader)
+            {
+                svg.active = reader.read<bool>();
+                std::wstring svgPath = reader.readWString();
+                svg._svgFile = svgPath.empty() ? nullptr : std::dynamic_pointer_cast<ExtensibleMarkupPackageFile>(PackageManager::lookupFileByPath(svgPath));
+                if (!svgPath.empty() && !svg._svgFile)
+                    Debug::logWarn("Restored `ScalableVectorGraphic` references \"", svgPath, "\", which isn't loaded.");
+                svg.dirty = true;
+            });
+
             InternalEngineEvent::OnRenderShutdown += []
             {
                 Text::characterPaths.clear();
                 ScalableVectorGraphic::loadedSvgs.clear();
             };
 
-            InternalEngineEvent::OnRenderOffloadForComponent += [](std::type_index typeIndex, Entity&, std::shared_ptr<void> component, ssz renderIndex)
+            InternalEngineEvent::OnRenderOffloadFor(componentID<Text>()) += [](Entity&, void* component, ssz renderIndex)
             {
-                if (typeIndex == typeid(Text))
-                    std::static_pointer_cast<Text>(component)->renderOffload(renderIndex);
+                static_cast<Text*>(component)->renderOffload(renderIndex);
             };
-            InternalEngineEvent::OnLateRenderOffloadForComponent += [](std::type_index typeIndex, Entity&, std::shared_ptr<void> component, ssz renderIndex)
+            InternalEngineEvent::OnLateRenderOffloadFor(componentID<ScalableVectorGraphic>()) += [](Entity&, void* component, ssz renderIndex)
             {
-                if (typeIndex == typeid(ScalableVectorGraphic))
-                    std::static_pointer_cast<ScalableVectorGraphic>(component)->lateRenderOffload(renderIndex);
+                static_cast<ScalableVectorGraphic*>(component)->lateRenderOffload(renderIndex);
             };
 
             CoreEngine::queueRenderJobForFrame([]
@@ -16,6 +16,7 @@ using namespace Firework::Internal;
 using namespace Firework::PackageSystem;
 
 robin_hood::unordered_map<PackageSystem::ExtensibleMarkupPackageFile*, std::shared_ptr<std::vector<ScalableVectorGraphic::Renderable>>> ScalableVectorGraphic::loadedSvgs;
+std::mutex ScalableVectorGraphic::loadedSvgsLock;
 
 void ScalableVectorGraphic::onAttach(Entity& entity)
 {
@@ -24,8 +25,11 @@ void ScalableVectorGraphic::onAttach(Entity& entity)
 
 std::shared_ptr<std::vector<ScalableVectorGraphic::Renderable>> ScalableVectorGraphic::findOrCreateRenderablePath(PackageSystem::ExtensibleMarkupPackageFile& svg)
 {
-    const auto svgIt = ScalableVectorGraphic::loadedSvgs.find(&svg);
-    _fence_value_return(svgIt->second, svgIt != ScalableVectorGraphic::loadedSvgs.end());
+    {
+        std::lock_guard guard(ScalableVectorGraphic::loadedSvgsLock);
+        const auto svgIt = ScalableVectorGraphic::loadedSvgs.find(&svg);
+        _fence_value_return(svgIt->second, svgIt != ScalableVectorGraphic::loadedSvgs.end());
+    }
 
     std::vector<Renderable> ret;
 
@@ -132,11 +136,13 @@ std::shared_ptr<std::vector<ScalableVectorGraphic::Renderable>> ScalableVectorGr
     _fence_value_return(nullptr, ret.empty());
 
     std::shared_ptr<std::vector<ScalableVectorGraphic::Renderable>> ptr = std::make_shared<std::vector<ScalableVectorGraphic::Renderable>>(std::move(ret));
-    ScalableVectorGraphic::loadedSvgs.emplace(&svg, ptr);
-    return ptr;
+    // Another thread may have loaded the same SVG in the meantime, in which case theirs is kept.
+    std::lock_guard guard(ScalableVectorGraphic::loadedSvgsLock);
+    return ScalableVectorGraphic::loadedSvgs.emplace(&svg, ptr).first->second;
 }
 void ScalableVectorGraphic::buryLoadedSvgIfOrphaned(PackageSystem::ExtensibleMarkupPackageFile* svg)
 {
+    std::lock_guard guard(ScalableVectorGraphic::loadedSvgsLock);
     auto svgIt = ScalableVectorGraphic::loadedSvgs.find(svg);
     _fence_value_return(void(), svgIt == ScalableVectorGraphic::loadedSvgs.end());
 
@@ -6,6 +6,7 @@
 #include <robin_hood.h>
 
 #include <Components/ComponentData.h>
+#include <EntityComponentSystem/Entity.h>
 #include <Friends/ShapeRenderer.h>
 #include <Friends/VectorParser.h>
 #include <Friends/VectorTools.h>
@@ -90,7 +91,9 @@ namespace Firework
             }
         };
 
+        // Guarded by `loadedSvgsLock`, render offload runs on worker threads.
         static robin_hood::unordered_map<PackageSystem::ExtensibleMarkupPackageFile*, std::shared_ptr<std::vector<Renderable>>> loadedSvgs;
+        static std::mutex loadedSvgsLock;
 
         std::shared_ptr<RectTransform> rectTransform = nullptr;
 
@@ -117,17 +120,18 @@ namespace Firework
         void buryLoadedSvgIfOrphaned(PackageSystem::ExtensibleMarkupPackageFile* svg);
 
         void lateRenderOffload(ssz renderIndex);
-    public:
-        Property<std::shared_ptr<PackageSystem::ExtensibleMarkupPackageFile>, std::shared_ptr<PackageSystem::ExtensibleMarkupPackageFile>> svgFile {
-            [this]() -> std::shared_ptr<PackageSystem::ExtensibleMarkupPackageFile> { return this->_svgFile; },
-            [this](std::shared_ptr<PackageSystem::ExtensibleMarkupPackageFile> value) -> void
+
+        inline void setSvgFile(std::shared_ptr<PackageSystem::ExtensibleMarkupPackageFile> value)
         {
             _fence_value_return(void(), this->_svgFile == value);
 
             this->dirty = true;
+            Entities::markChanged(*this);
             this->_svgFile = std::move(value);
         }
-        };
+    public:
+        _fw_property(ScalableVectorGraphic, svgFile, std::shared_ptr<PackageSystem::ExtensibleMarkupPackageFile>,
+                     std::shared_ptr<PackageSystem::ExtensibleMarkupPackageFile>, &ScalableVectorGraphic::_svgFile, &ScalableVectorGraphic::setSvgFile);
 
         friend struct ::ComponentStaticInit;
         friend class Firework::Entity;
@@ -16,6 +16,7 @@ using namespace Firework::PackageSystem;
 using namespace Firework::Typography;
 
 robin_hood::unordered_map<Text::FontCharacterQuery, std::shared_ptr<ShapeRenderer>, Text::FontCharacterQueryHash> Text::characterPaths;
+std::mutex Text::characterPathsLock;
 
 void Text::onAttach(Entity& entity)
 {
@@ -24,8 +25,11 @@ void Text::onAttach(Entity& entity)
 
 std::shared_ptr<ShapeRenderer> Text::findOrCreateGlyphPath(char32_t c)
 {
-    auto charPathIt = Text::characterPaths.find(FontCharacterQuery { .file = this->_font.get(), .c = c });
-    _fence_value_return(charPathIt->second, charPathIt != Text::characterPaths.end());
+    {
+        std::lock_guard guard(Text::characterPathsLock);
+        auto charPathIt = Text::characterPaths.find(FontCharacterQuery { .file = this->_font.get(), .c = c });
+        _fence_value_return(charPathIt->second, charPathIt != Text::characterPaths.end());
+    }
 
     const Font& f = this->_font->fontHandle();
     int glyphIndex = f.getGlyphIndex(c);
@@ -76,12 +80,13 @@ std::shared_ptr<ShapeRenderer> Text::findOrCreateGlyphPath(char32_t c)
     std::transform(shapeCurveInds.begin(), shapeCurveInds.end(), std::back_inserter(shapeInds), [curvePointsBegin](const uint16_t i) { return +(i + u16(curvePointsBegin)); });
     std::shared_ptr<ShapeRenderer> pathRenderers = std::make_shared<ShapeRenderer>(shapePoints, shapeInds, curveIndsBegin);
 
-    Text::characterPaths.emplace(FontCharacterQuery { .file = this->_font.get(), .c = c }, pathRenderers);
-
-    return pathRenderers;
+    // Another thread may have built the same glyph in the meantime, in which case theirs is kept.
+    std::lock_guard guard(Text::characterPathsLock);
+    return Text::characterPaths.emplace(FontCharacterQuery { .file = this->_font.get(), .c = c }, pathRenderers).first->second;
 }
 void Text::tryBuryOrphanedGlyphPathSixFeetUnder(const FontCharacterQuery q)
 {
+    std::lock_guard guard(Text::characterPathsLock);
     auto charPathIt = Text::characterPaths.find(q);
     _fence_value_return(void(), charPathIt == Text::characterPaths.end());
 
@@ -3,6 +3,7 @@
 #include "Firework.Components.Core2D.Exports.h"
 
 #include <glm/vec4.hpp>
+#include <mutex>
 
 #include <Components/ComponentData.h>
 #include <Core/CoreEngine.h>
@@ -45,8 +46,9 @@ namespace Firework
             }
         };
 
-        // Main thread only.
+        // Guarded by `characterPathsLock`, render offload runs on worker threads.
         static robin_hood::unordered_map<FontCharacterQuery, std::shared_ptr<ShapeRenderer>, FontCharacterQueryHash> characterPaths;
+        static std::mutex characterPathsLock;
 
         std::shared_ptr<RectTransform> rectTransform = nullptr;
 
@@ -73,35 +75,42 @@ namespace Firework
         void swapRenderBuffers();
 
         void renderOffload(ssz renderIndex);
-    public:
-        const Property<std::shared_ptr<PackageSystem::TrueTypeFontPackageFile>, std::shared_ptr<PackageSystem::TrueTypeFontPackageFile>> font {
-            [this]() -> std::shared_ptr<PackageSystem::TrueTypeFontPackageFile> { return this->_font; },
-            [this](std::shared_ptr<PackageSystem::TrueTypeFontPackageFile> value)
+
+        inline void setFont(std::shared_ptr<PackageSystem::TrueTypeFontPackageFile> value)
         {
             _fence_value_return(void(), this->_font == value);
 
             this->dirty = true;
+            Entities::markChanged(*this);
             this->_font = std::move(value);
         }
-        };
-        const Property<float, float> fontSize { [this]() -> float { return this->_fontSize; }, [this](float value) -> void
+        inline void setFontSize(float value)
         {
             _fence_value_return(void(), this->_fontSize == value);
 
             this->dirty = true;
+            Entities::markChanged(*this);
             this->_fontSize = value;
-        } };
-
-        const Property<std::u32string, std::u32string> text { [this]() -> const std::u32string& { return this->_text; }, [this](std::u32string value)
+        }
+        inline void setText(std::u32string value)
         {
             this->dirty = true;
+            Entities::markChanged(*this);
             this->_text = std::move(value);
-        } };
-        const Property<Color, const Color&> color { [this]() -> Color { return this->_color; }, [this](const Color& value)
+        }
+        inline void setColor(const Color& value)
         {
             this->dirty = true;
+            Entities::markChanged(*this);
             this->_color = value;
-        } };
+        }
+    public:
+        _fw_property(Text, font, std::shared_ptr<PackageSystem::TrueTypeFontPackageFile>, std::shared_ptr<PackageSystem::TrueTypeFontPackageFile>, &Text::_font,
+                     &Text::setFont);
+        _fw_property(Text, fontSize, float, float, &Text::_fontSize, &Text::setFontSize);
+
+        _fw_property(Text, text, std::u32string, std::u32string, &Text::_text, &Text::setText);
+        _fw_property(Text, color, Color, const Color&, &Text::_color, &Text::setColor);
 
         friend struct ::ComponentStaticInit;
         friend class Firework::Entity;
@@ -51,6 +51,18 @@
 #define FIREWORK_EXCEPTION_TRACE_DEPTH 64
 #endif
 
+#ifndef FIREWORK_PROFILER
+#define FIREWORK_PROFILER 0
+#endif
+
+#ifndef FIREWORK_ECS_ACCESS_CHECKS
+#if _DEBUG
+#define FIREWORK_ECS_ACCESS_CHECKS 1
+#else
+#define FIREWORK_ECS_ACCESS_CHECKS 0
+#endif
+#endif
+
 #include <chrono>
 
 namespace Firework
@@ -61,16 +73,43 @@ namespace Firework
 
         constexpr static bool AsyncDebugLogging = false;
 
-        constexpr static enum class LatencyTradeSetting : uint_least8_t
-        {
-            None,
-            ThreadYield,
-            ThreadSleep
-        } LatencyTrade = LatencyTradeSetting::ThreadSleep;
-        constexpr static auto UnspecifiedSleepDuration = std::chrono::microseconds(250);
+        /// @brief How long an idle engine thread spins waiting for work before going to sleep. Higher values trade CPU time for hand-off latency.
+        /// `std::chrono::nanoseconds::max()` busy-waits, zero sleeps immediately.
+        constexpr static std::chrono::nanoseconds ParkSpinDuration = std::chrono::microseconds(50);
+        /// @brief How long before a frame deadline the main thread stops sleeping and spins instead. Should cover the OS scheduler's wake-up jitter.
+        constexpr static std::chrono::nanoseconds FramePacingSpinThreshold = std::chrono::microseconds(1500);
+        /// @brief How close, as a fraction of a display refresh, the target frame time has to be to a whole number of refreshes to be snapped to it.
+        constexpr static float FramePacingSnapTolerance = 0.05f;
+        /// @brief Number of frames frame time statistics are computed over.
+        constexpr static size_t FrameStatisticsWindow = 240;
+        /// @brief Number of zones each thread's profiler ring buffer holds. Older zones are overwritten. Must be a power of two.
+        constexpr static size_t ProfilerZonesPerThread = 16384;
+        /// @brief Number of frames the profiler keeps the start times of, and so the most frames a trace can cover.
+        constexpr static size_t ProfilerFrameHistory = 256;
+        /// @brief Upper bound on how long the window thread sleeps waiting for events, as a safety net for wake-ups SDL can't deliver.
+        constexpr static auto WindowThreadWaitTimeout = std::chrono::milliseconds(100);
+
+        /// @brief Number of hardware threads left to the main, render and window threads. The scheduler gets the rest, and always at least one worker.
+        constexpr static unsigned ReservedEngineThreads = 3;
+
+        /// @brief Number of entities per page of the entity pool. Pages are allocated as the pool grows, and never freed.
+        constexpr static size_t EntityPoolPageSize = 1024;
+        /// @brief Default number of entities per task of `Entities::forEachParallel`.
+        constexpr static size_t EntityForEachGrain = 256;
+        /// @brief Number of bytes per chunk of a component pool. Chunks are allocated as a pool grows, and never freed, freed components are reused instead.
+        constexpr static size_t ComponentPoolChunkSize = 16384;
 
         constexpr static int MaxFramesInFlight = 2;
 
         constexpr static int GraphicsQueueOverburdenedThreshold = 24;
+        /// @brief Number of components per render offload task. Each task records into its own command buffer.
+        constexpr static size_t RenderOffloadGrain = 128;
+        /// @brief Maximum number of render jobs in flight. Producers yield while the render queue is full. Must be a power of two.
+        constexpr static size_t RenderQueueCapacity = 8192;
+        /// @brief Maximum number of input events buffered between frames. Mouse motion, scroll and key repeat events past this are dropped, others are held back by
+        /// the window thread until there's room. Must be a power of two.
+        constexpr static size_t InputQueueCapacity = 1024;
+        /// @brief How long the window thread sleeps waiting for events while it holds back input events the buffer had no room for, before trying again.
+        constexpr static auto InputOverflowRetryInterval = std::chrono::milliseconds(1);
     };
 } // namespace Firework
@@ -30,6 +30,7 @@ void RectTransform::setRect(const RectFloat& value)
 {
     this->_dirty = true;
     this->matrixDirty = true;
+    Entities::markChanged(*this);
 
     RectFloat delta = value - this->_rect;
     this->_rect = value;
@@ -43,6 +44,7 @@ void RectTransform::setRect(const RectFloat& value)
             {
                 rectTransform->_dirty = true;
                 rectTransform->matrixDirty = true;
+                Entities::markChanged(*rectTransform);
                 localDelta *= rectTransform->_anchor;
                 rectTransform->_rect += localDelta;
                 if (rectTransform->_positionAnchor != RectFloat(0.0f))
@@ -62,6 +64,7 @@ void RectTransform::setPosition(glm::vec2 value)
 {
     this->_dirty = true;
     this->matrixDirty = true;
+    Entities::markChanged(*this);
 
     glm::vec2 delta = value - this->_position;
     this->_position = value;
@@ -74,6 +77,7 @@ void RectTransform::setPosition(glm::vec2 value)
             {
                 rectTransform->_dirty = true;
                 rectTransform->matrixDirty = true;
+                Entities::markChanged(*rectTransform);
                 rectTransform->_position += delta;
             }
             setChildrenPositionRecursive(setChildrenPositionRecursive, child);
@@ -85,6 +89,7 @@ void RectTransform::setRotation(float value)
 {
     this->_dirty = true;
     this->matrixDirty = true;
+    Entities::markChanged(*this);
 
     float delta = value - this->_rotation;
     this->_rotation = value;
@@ -97,6 +102,7 @@ void RectTransform::setRotation(float value)
             {
                 rectTransform->_dirty = true;
                 rectTransform->matrixDirty = true;
+                Entities::markChanged(*rectTransform);
                 rectTransform->_rotation += delta;
                 rotatePointAround(rectTransform->_position, this->_position, delta);
             }
@@ -109,6 +115,7 @@ void RectTransform::setScale(glm::vec2 value)
 {
     this->_dirty = true;
     this->matrixDirty = true;
+    Entities::markChanged(*this);
 
     glm::vec2 delta = value / this->_scale;
     this->_scale = value;
@@ -121,6 +128,7 @@ void RectTransform::setScale(glm::vec2 value)
             {
                 rectTransform->_dirty = true;
                 rectTransform->matrixDirty = true;
+                Entities::markChanged(*rectTransform);
                 rectTransform->_scale *= delta;
                 rectTransform->_position = delta * (rectTransform->_position - this->_position) + this->_position;
             }
@@ -132,7 +140,7 @@ void RectTransform::setScale(glm::vec2 value)
 
 std::shared_ptr<RectTransform> RectTransform::parent() const
 {
-    for (std::shared_ptr<Entity> parent = this->attachedEntity->parent; parent; parent = parent->parent)
+    for (EntityHandle parent = this->attachedEntity->parent; parent; parent = parent->parent)
     {
         if (std::shared_ptr<RectTransform> rectTransform = parent->getComponent<RectTransform>())
             return rectTransform;
@@ -156,6 +164,7 @@ void RectTransform::setLocalPosition(glm::vec2 value)
 {
     this->_dirty = true;
     this->matrixDirty = true;
+    Entities::markChanged(*this);
 
     std::shared_ptr<RectTransform> parent = this->parent();
     glm::vec2 delta;
@@ -176,6 +185,7 @@ void RectTransform::setLocalPosition(glm::vec2 value)
             {
                 rectTransform->_dirty = true;
                 rectTransform->matrixDirty = true;
+                Entities::markChanged(*rectTransform);
                 rectTransform->_position += delta;
             }
             setChildrenPositionRecursive(setChildrenPositionRecursive, child);
@@ -192,6 +202,7 @@ void RectTransform::setLocalRotation(float value)
 {
     this->_dirty = true;
     this->matrixDirty = true;
+    Entities::markChanged(*this);
 
     std::shared_ptr<RectTransform> parent = this->parent();
     float delta;
@@ -209,6 +220,7 @@ void RectTransform::setLocalRotation(float value)
             {
                 rectTransform->_dirty = true;
                 rectTransform->matrixDirty = true;
+                Entities::markChanged(*rectTransform);
                 rectTransform->_rotation += delta;
                 rotatePointAround(rectTransform->_position, this->_position, delta);
             }
@@ -226,6 +238,7 @@ void RectTransform::setLocalScale(glm::vec2 value)
 {
     this->_dirty = true;
     this->matrixDirty = true;
+    Entities::markChanged(*this);
 
     std::shared_ptr<RectTransform> parent = this->parent();
     glm::vec2 delta;
@@ -243,6 +256,7 @@ void RectTransform::setLocalScale(glm::vec2 value)
             {
                 rectTransform->_dirty = true;
                 rectTransform->matrixDirty = true;
+                Entities::markChanged(*rectTransform);
                 rectTransform->_scale *= delta;
                 rectTransform->_position = delta * (rectTransform->_position - this->_position) + this->_position;
             }
@@ -252,19 +266,21 @@ void RectTransform::setLocalScale(glm::vec2 value)
     setChildrenScaleRecursive(setChildrenScaleRecursive, *this->attachedEntity);
 }
 
-const glm::mat4& RectTransform::matrix()
+void RectTransform::resolveMatrix()
 {
-    if (this->matrixDirty)
-    {
-        glm::mat4 tf = glm::translate(glm::mat4(1.0f), glm::vec3(this->_position.x, this->_position.y, 0.0f));
-        tf = glm::rotate(tf, -this->_rotation, LinAlgConstants::forward);
-        tf = glm::translate(tf, glm::vec3((this->_rect.right + this->_rect.left) / 2.0f, (this->_rect.top + this->_rect.bottom) / 2.0f, 0.0f));
-        tf = glm::scale(tf, glm::vec3(this->_rect.width() * this->_scale.x, this->_rect.height() * this->_scale.y, 0.0f));
-        this->_matrix = tf;
+    _fence_value_return(void(), !this->matrixDirty);
 
-        this->matrixDirty = false;
-    }
+    glm::mat4 tf = glm::translate(glm::mat4(1.0f), glm::vec3(this->_position.x, this->_position.y, 0.0f));
+    tf = glm::rotate(tf, -this->_rotation, LinAlgConstants::forward);
+    tf = glm::translate(tf, glm::vec3((this->_rect.right + this->_rect.left) / 2.0f, (this->_rect.top + this->_rect.bottom) / 2.0f, 0.0f));
+    tf = glm::scale(tf, glm::vec3(this->_rect.width() * this->_scale.x, this->_rect.height() * this->_scale.y, 0.0f));
+    this->_matrix = tf;
 
+    this->matrixDirty = false;
+}
+const glm::mat4& RectTransform::matrix() const
+{
+    _fence_contract_enforce(!this->matrixDirty);
     return this->_matrix;
 }
 
@@ -18,6 +18,7 @@ _push_nowarn_msvc(_clWarn_msvc_export_interface);
 namespace Firework
 {
     class Debug;
+    class EntitySnapshot;
     class RectTransform;
 
     /// @brief Describes the bounds of a rectangle, with float.
@@ -76,7 +77,7 @@ namespace Firework
     /// @brief The transform component of a 2D entity.
     class _fw_core_api RectTransform final
     {
-        std::shared_ptr<class Entity> attachedEntity = nullptr;
+        EntityHandle attachedEntity;
 
         RectFloat _rect { 10, 10, -10, -10 };
         RectFloat _anchor { 0, 0, 0, 0 };
@@ -92,12 +93,27 @@ namespace Firework
 
         void onAttach(Entity& entity)
         {
-            this->attachedEntity = entity.shared_from_this();
+            this->attachedEntity = entity.handle();
         }
 
         std::shared_ptr<RectTransform> parent() const;
 
+        /// @internal
+        /// @brief Internal API. Recompute the cached matrix of this transform, if it was modified since it was last computed.
+        /// @note Main thread only.
+        void resolveMatrix();
+
         void setRect(const RectFloat& value);
+        inline void setRectAnchor(const RectFloat& value)
+        {
+            this->_anchor = value;
+            Entities::markChanged(*this);
+        }
+        inline void setPositionAnchor(const RectFloat& value)
+        {
+            this->_positionAnchor = value;
+            Entities::markChanged(*this);
+        }
 
         /// @internal
         /// @brief Internal API. Set the position of this transform.
@@ -153,79 +169,52 @@ namespace Firework
         /// @param value ```const Firework::RectFloat&```
         /// @return ```const Firework::RectFloat&```
         /// @note Main thread only.
-        const Property<const RectFloat&, const RectFloat&> rect { [this]() -> const RectFloat& { return this->_rect; }, [this](const RectFloat& value) -> void
-        {
-            this->setRect(value);
-        } };
+        _fw_property(RectTransform, rect, const RectFloat&, const RectFloat&, &RectTransform::_rect, &RectTransform::setRect);
         /// @property
         /// @brief [Property] The anchor for the rectangle bounds of this transform.
         /// @param value ```const Firework::RectFloat&```
         /// @return ```const Firework::RectFloat&```
         /// @note Main thread only.
-        const Property<const RectFloat&, const RectFloat&> rectAnchor { [this]() -> const RectFloat& { return this->_anchor; }, [this](const RectFloat& value) -> void
-        {
-            this->_anchor = value;
-        } };
-        const Property<const RectFloat&, const RectFloat&> positionAnchor { [this]() -> const RectFloat& { return this->_positionAnchor; }, [this](const RectFloat& value) -> void
-        {
-            this->_positionAnchor = value;
-        } };
+        _fw_property(RectTransform, rectAnchor, const RectFloat&, const RectFloat&, &RectTransform::_anchor, &RectTransform::setRectAnchor);
+        _fw_property(RectTransform, positionAnchor, const RectFloat&, const RectFloat&, &RectTransform::_positionAnchor, &RectTransform::setPositionAnchor);
 
         /// @property
         /// @brief [Property] The position of this transform.
         /// @param value ```glm::vec2```
         /// @return ```glm::vec2```
         /// @note Main thread only.
-        const Property<glm::vec2, glm::vec2> position { [this]() -> glm::vec2 { return this->_position; }, [this](glm::vec2 value) -> void
-        {
-            this->setPosition(value);
-        } };
+        _fw_property(RectTransform, position, glm::vec2, glm::vec2, &RectTransform::_position, &RectTransform::setPosition);
         /// @property
         /// @brief [Property] The rotation of this transform in radians.
         /// @param value ```float```
         /// @return ```float```
         /// @note Main thread only.
-        const Property<float, float> rotation { [this]() -> float { return this->_rotation; }, [this](float value) -> void
-        {
-            this->setRotation(value);
-        } };
+        _fw_property(RectTransform, rotation, float, float, &RectTransform::_rotation, &RectTransform::setRotation);
         /// @property
         /// @brief [Property] The scale of this transform.
         /// @param value ```glm::vec2```
         /// @return ```glm::vec2```
         /// @note Main thread only.
-        const Property<glm::vec2, glm::vec2> scale { [this]() -> glm::vec2 { return this->_scale; }, [this](glm::vec2 value) -> void
-        {
-            this->setScale(value);
-        } };
+        _fw_property(RectTransform, scale, glm::vec2, glm::vec2, &RectTransform::_scale, &RectTransform::setScale);
 
         /// @property
         /// @brief [Property] The local position of this transform.
         /// @param value ```glm::vec2```
         /// @return ```glm::vec2```
         /// @note Main thread only.
-        const Property<glm::vec2, glm::vec2> localPosition { [this]() -> glm::vec2 { return this->getLocalPosition(); }, [this](glm::vec2 value) -> void
-        {
-            this->setLocalPosition(value);
-        } };
+        _fw_property(RectTransform, localPosition, glm::vec2, glm::vec2, &RectTransform::getLocalPosition, &RectTransform::setLocalPosition);
         /// @property
         /// @brief [Property] The local rotation of this transform in radians.
         /// @param value ```float```
         /// @return ```float```
         /// @note Main thread only.
-        const Property<float, float> localRotation { [this]() -> float { return this->getLocalRotation(); }, [this](float value) -> void
-        {
-            this->setLocalRotation(value);
-        } };
+        _fw_property(RectTransform, localRotation, float, float, &RectTransform::getLocalRotation, &RectTransform::setLocalRotation);
         /// @property
         /// @brief [Property] The local scale of this transform.
         /// @param value ```glm::vec2```
         /// @return ```glm::vec2```
         /// @note Main thread only.
-        const Property<glm::vec2, glm::vec2> localScale { [this]() -> glm::vec2 { return this->getLocalScale(); }, [this](glm::vec2 value) -> void
-        {
-            this->setLocalScale(value);
-        } };
+        _fw_property(RectTransform, localScale, glm::vec2, glm::vec2, &RectTransform::getLocalScale, &RectTransform::setLocalScale);
 
         /// @property
         /// @brief [Property] Whether this ```Firework::RectTransform``` has been modified this logic frame.
@@ -243,7 +232,10 @@ namespace Firework
             this->_dirty = false;
         }
 
-        const glm::mat4& matrix();
+        /// @brief Retrieve the matrix transforming the unit square to the rectangle of this transform.
+        /// @return Matrix of this transform.
+        /// @note Render offload only. The engine resolves every matrix before offload starts, so this only reads, and is safe from every worker at once.
+        const glm::mat4& matrix() const;
 
         /// @brief Check whether a point is within the rectangle of this transform.
         /// @param point Point to query.
@@ -253,6 +245,7 @@ namespace Firework
 
         friend class Firework::Internal::CoreEngine;
         friend class Firework::Entity;
+        friend class Firework::EntitySnapshot;
         friend class Firework::Debug;
     };
 } // namespace Firework
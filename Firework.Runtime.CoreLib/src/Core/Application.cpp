@@ -11,14 +11,24 @@ using namespace Firework::Internal;
 moodycamel::ConcurrentQueue<func::function<void()>> Application::mainThreadQueue;
 moodycamel::ConcurrentQueue<func::function<void()>> Application::windowThreadQueue;
 
-std::atomic_flag Application::workerThreadQueueNotif = ATOMIC_FLAG_INIT;
-moodycamel::ConcurrentQueue<func::function<void()>> Application::workerThreadQueue;
+ThreadParker Application::mainThreadParker;
 
 float Application::secondsPerFrame = 1.0f / 160.0f;
 
-int Application::run(int argc, char* argv[])
+int Application::run(int argc, char* argv[], const RunOptions& options)
 {
-    return CoreEngine::execute(argc, argv);
+    return CoreEngine::execute(argc, argv, options);
+}
+void Application::notifyWindowThread()
+{
+    uint32_t eventType = CoreEngine::windowWakeEventType.load(std::memory_order_acquire);
+    if (!eventType || CoreEngine::windowWakePending.test_and_set()) // Not up yet, or a wake-up is already on its way.
+        return;
+
+    SDL_Event ev {};
+    ev.type = eventType;
+    if (!SDL_PushEvent(&ev))
+        CoreEngine::windowWakePending.clear();
 }
 void Application::quit()
 {
@@ -3,10 +3,13 @@
 #include "Firework.Runtime.CoreLib.Exports.h"
 
 #include <concurrentqueue.h>
+#include <cstdint>
 #include <function.h>
 #include <glm/vec2.hpp>
 
+#include <Core/Scheduler.h>
 #include <Library/Property.h>
+#include <Library/ThreadParker.h>
 
 namespace Firework::Internal
 {
@@ -24,14 +27,29 @@ namespace Firework
 {
     class Image;
 
+    /// @brief Options for `Application::run`. Each can also be set from the command line, which takes precedence.
+    struct RunOptions
+    {
+        /// @brief Run without a display or GPU, using SDL's offscreen (or dummy) video driver and the no-op renderer. Frames run as normal, but nothing is presented.
+        /// Command line: `--headless`.
+        bool headless = false;
+        /// @brief Exit after this many frames, zero runs until quit. Command line: `--frames=<count>`.
+        uint64_t frameLimit = 0;
+        /// @brief Run frames back to back, ignoring the target frame rate. Command line: `--uncapped`.
+        bool uncapped = false;
+    };
+
     /// @brief Static class containing functionality relevant to the currently running program.
     class _fw_core_api Application final
     {
         static moodycamel::ConcurrentQueue<func::function<void()>> mainThreadQueue;
         static moodycamel::ConcurrentQueue<func::function<void()>> windowThreadQueue;
 
-        static std::atomic_flag workerThreadQueueNotif;
-        static moodycamel::ConcurrentQueue<func::function<void()>> workerThreadQueue;
+        static ThreadParker mainThreadParker;
+        /// @internal
+        /// @brief Internal API. Wake the window thread if it's waiting for events.
+        /// @note Thread-safe.
+        static void notifyWindowThread();
 
         static float secondsPerFrame;
     public:
@@ -46,18 +64,17 @@ namespace Firework
         inline static void queueJobForMainThread(Func&& job)
         {
             Application::mainThreadQueue.enqueue(job);
+            Application::mainThreadParker.unpark();
         }
         /// @internal
-        /// @brief Low-level API [Internal]. Queues a function to be run on the background worker thread.
+        /// @brief Low-level API [Internal]. Queues a function to be run on a background worker thread.
         /// @tparam Func ```requires std::invocable<Func>```
         /// @param job Job to queue.
-        /// @note Thread-safe.
+        /// @note Thread-safe. Jobs may run concurrently, and in any order. Use `Firework::Scheduler` directly for handles and dependencies.
         template <std::invocable<> Func>
         inline static void queueJobForWorkerThread(Func&& job)
         {
-            Application::workerThreadQueue.enqueue(job);
-            Application::workerThreadQueueNotif.test_and_set();
-            Application::workerThreadQueueNotif.notify_one();
+            (void)Scheduler::submit(std::forward<Func>(job));
         }
         /// @internal
         /// @brief Low-level API [Internal]. Queues a function to be run on the window thread.
@@ -68,6 +85,7 @@ namespace Firework
         inline static void queueJobForWindowThread(Func&& job)
         {
             Application::windowThreadQueue.enqueue(job);
+            Application::notifyWindowThread();
         }
 
         /// @brief Sets the minimum frame time by frames-per-second.
@@ -90,11 +108,12 @@ namespace Firework
         /// @warning Don't call this more than once!
         /// @param argc Forwarded from int main(...).
         /// @param argv Forwarded from int main(...).
+        /// @param options How to run, e.g. headless for benchmarking on machines without a display or GPU.
         /// @return Whether the runtime was able to start successfully.
         /// @retval - `EXIT_SUCCESS`: The runtime initialized successfully.
         /// @retval - `EXIT_FAILIURE`: The runtime failed to initialize.
         /// @note Thread-safe.
-        static int run(int argc, char* argv[]);
+        static int run(int argc, char* argv[], const RunOptions& options = RunOptions());
 
         /// @brief Politely request that the runtime should exit.
         /// @note Main thread only.
@@ -1,6 +1,7 @@
 #include "CoreEngine.h"
 
 #include <algorithm>
+#include <charconv>
 #include <chrono>
 #include <cmath>
 #include <thread>
@@ -32,13 +33,18 @@
 #include <Core/Application.h>
 #include <Core/Debug.h>
 #include <Core/Display.h>
+#include <Core/FramePacer.h>
 #include <Core/HardwareExcept.h>
 #include <Core/Input.h>
 #include <Core/PackageManager.h>
+#include <Core/Profiler.h>
+#include <Core/Scheduler.h>
 #include <Core/Time.h>
 #include <EntityComponentSystem/EngineEvent.h>
 #include <EntityComponentSystem/Entity.h>
+#include <EntityComponentSystem/EntityCommandBuffer.h>
 #include <EntityComponentSystem/EntityManagement.h>
+#include <EntityComponentSystem/EntitySnapshot.h>
 #include <Firework/Config.h>
 #include <GL/RenderPipeline.h>
 #include <GL/Renderer.h>
@@ -55,14 +61,74 @@ const SDL_DisplayMode* CoreEngine::displMd = nullptr;
 
 std::atomic_flag CoreEngine::state[size_t(EngineState::Count)] {};
 
-std::deque<RenderJob> CoreEngine::renderQueue;
-std::mutex CoreEngine::renderQueueLock;
+RingQueue<RenderJob, Config::RenderQueueCapacity> CoreEngine::renderQueue;
+std::mutex CoreEngine::renderThreadLock;
+ThreadParker CoreEngine::renderThreadParker;
 std::atomic<uint_fast8_t> CoreEngine::framesInFlight = 0;
 
-int CoreEngine::execute(int argc, char* argv[])
+RunOptions CoreEngine::runOptions;
+
+std::atomic<uint64_t> CoreEngine::droppedRenderJobs = 0;
+std::atomic<uint64_t> CoreEngine::droppedFrames = 0;
+std::atomic<uint64_t> CoreEngine::coalescedRenderJobs = 0;
+
+std::atomic<uint32_t> CoreEngine::windowWakeEventType = 0;
+std::atomic_flag CoreEngine::windowWakePending = ATOMIC_FLAG_INIT;
+
+RenderCommandList CoreEngine::frameCommandLists[Config::MaxFramesInFlight + 1];
+static thread_local RenderCommandBuffer* threadRecordingCommandBuffer = nullptr;
+
+RenderCommandBuffer* CoreEngine::recordingCommandBuffer()
 {
-    (void)argc;
-    (void)argv;
+    return threadRecordingCommandBuffer;
+}
+
+RenderQueueStatistics CoreEngine::renderQueueStatistics()
+{
+    return RenderQueueStatistics { .droppedJobs = CoreEngine::droppedRenderJobs.load(std::memory_order_relaxed),
+                                   .droppedFrames = CoreEngine::droppedFrames.load(std::memory_order_relaxed),
+                                   .coalescedJobs = CoreEngine::coalescedRenderJobs.load(std::memory_order_relaxed) };
+}
+
+void CoreEngine::executeFrame(RenderCommandList& commandList, bool stale)
+{
+    _fw_profile_zone("Render Frame");
+
+    size_t superseded;
+    if (stale)
+        superseded = commandList.execute(true);
+    else
+    {
+        RenderPipeline::clearViewArea();
+        superseded = commandList.execute();
+
+        _fw_profile_zone("bgfx::frame");
+        RenderPipeline::renderFrame();
+    }
+    if (superseded)
+        CoreEngine::coalescedRenderJobs.fetch_add(superseded, std::memory_order_relaxed);
+
+    commandList.reset();
+    CoreEngine::framesInFlight--;
+}
+
+int CoreEngine::execute(int argc, char* argv[], const RunOptions& options)
+{
+    CoreEngine::runOptions = options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg = argv[i];
+        if (arg == "--headless")
+            CoreEngine::runOptions.headless = true;
+        else if (arg == "--uncapped")
+            CoreEngine::runOptions.uncapped = true;
+        else if (arg.starts_with("--frames="))
+        {
+            arg.remove_prefix(std::string_view("--frames=").size());
+            if (std::from_chars(arg.data(), arg.data() + arg.size(), CoreEngine::runOptions.frameLimit).ec != std::errc()) [[unlikely]]
+                Debug::logWarn("Ignoring invalid frame limit \"", arg, "\".");
+        }
+    }
 
 #if _WIN32 // Windows ANSI Escape Sequence Support
     if (IsWindowsVistaOrGreater())
@@ -81,16 +147,9 @@ int CoreEngine::execute(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    std::thread workerThread([]
-    {
-        func::function<void()> event;
-        while (!CoreEngine::state[size_t(EngineState::WindowThreadDone)].test())
-        {
-            Application::workerThreadQueueNotif.wait(false);
-            while (Application::workerThreadQueue.try_dequeue(event)) event();
-            Application::workerThreadQueueNotif.clear();
-        }
-    });
+    Scheduler::startup();
+
+    PackageManager::addBinaryFileHandler<EntitySnapshotPackageFile>(std::vector<uint8_t>(std::begin(EntitySnapshot::Magic), std::end(EntitySnapshot::Magic)));
 
     {
         std::jthread windowThread(internalWindowLoop);
@@ -98,9 +157,7 @@ int CoreEngine::execute(int argc, char* argv[])
         std::jthread mainThread(internalLoop);
     }
 
-    Application::workerThreadQueueNotif.test_and_set();
-    Application::workerThreadQueueNotif.notify_one();
-    workerThread.join();
+    Scheduler::shutdown();
 
     // Cleanup here is done for stuff created in CoreEngine::execute, thread-specific cleanup is done per-thread, at the end of their lifetime.
 
@@ -182,6 +239,80 @@ constexpr static auto userFunctionInvoker = [](auto&& func)
     __hwEnd();
 };
 
+void CoreEngine::dispatchInput(std::vector<InputRecord>& records)
+{
+    // Edges only last a frame, even one without input.
+    Input::pressedMouseButtons.clear();
+    Input::releasedMouseButtons.clear();
+    Input::pressedKeys.clear();
+    Input::releasedKeys.clear();
+
+    records.clear();
+    _fence_value_return(void(), !Input::inputQueue.tryDequeueBulk(records));
+
+    for (size_t i = 0; i < records.size();)
+    {
+        const InputRecord& record = records[i];
+        switch (record.type)
+        {
+        case InputRecordType::MouseMove:
+            {
+                // A run of motion is raised as a single move, from where the run started to where it ended.
+                glm::vec2 from = Input::internalMousePosition;
+                for (; i < records.size() && records[i].type == InputRecordType::MouseMove; i++)
+                {
+                    Input::internalMousePosition.x = records[i].mouseMove.x - Window::width / 2_u32;
+                    Input::internalMousePosition.y = -records[i].mouseMove.y + Window::height / 2_u32;
+                    Input::internalMouseMotion.x += records[i].mouseMove.xMotion;
+                    Input::internalMouseMotion.y -= records[i].mouseMove.yMotion;
+                }
+                userFunctionInvoker([&from] { EngineEvent::OnMouseMove(from); });
+            }
+            continue;
+        case InputRecordType::MouseScroll:
+            {
+                glm::vec2 scroll(0.0f);
+                for (; i < records.size() && records[i].type == InputRecordType::MouseScroll; i++) scroll += glm::vec2(records[i].mouseScroll.x, records[i].mouseScroll.y);
+                userFunctionInvoker([&scroll] { EngineEvent::OnMouseScroll(scroll); });
+            }
+            continue;
+        case InputRecordType::MouseDown:
+            Input::heldMouseButtons.set(record.button);
+            Input::pressedMouseButtons.set(record.button);
+            userFunctionInvoker([&record] { EngineEvent::OnMouseDown(record.button); });
+            break;
+        case InputRecordType::MouseUp:
+            Input::heldMouseButtons.reset(record.button);
+            Input::releasedMouseButtons.set(record.button);
+            userFunctionInvoker([&record] { EngineEvent::OnMouseUp(record.button); });
+            break;
+        case InputRecordType::KeyDown:
+            Input::heldKeys.set(record.key);
+            Input::pressedKeys.set(record.key);
+            userFunctionInvoker([&record] { EngineEvent::OnKeyDown(record.key); });
+            break;
+        case InputRecordType::KeyRepeat:
+            userFunctionInvoker([&record] { EngineEvent::OnKeyRepeat(record.key); });
+            break;
+        case InputRecordType::KeyUp:
+            Input::heldKeys.reset(record.key);
+            Input::releasedKeys.set(record.key);
+            userFunctionInvoker([&record] { EngineEvent::OnKeyUp(record.key); });
+            break;
+        case InputRecordType::TextInput:
+            {
+                // Text too long for one record is split across consecutive ones, stitch it back together. Separate events stay separate.
+                std::u32string input(record.textInput.text, record.textInput.length);
+                for (i++; i < records.size() && records[i].type == InputRecordType::TextInput && records[i].textInput.continues; i++)
+                    input.append(records[i].textInput.text, records[i].textInput.length);
+                userFunctionInvoker([&input] { EngineEvent::OnTextInput(input); });
+            }
+            continue;
+        }
+        ++i;
+    }
+}
+
 void CoreEngine::internalLoop()
 {
     CoreEngine::state[size_t(EngineState::WindowInit)].test_and_set(); // Spin off window handling thread.
@@ -192,15 +323,14 @@ void CoreEngine::internalLoop()
     CoreEngine::state[size_t(EngineState::Running)].test_and_set();
     CoreEngine::state[size_t(EngineState::Running)].notify_all();
 
+    Time::recordThreadStart(EngineThread::Main);
+    Profiler::setThreadName("Main");
+
     // IMPORTANT: A userlevel function block needs to be guarded with `userFunctionInvoker(...)` to catch exceptions and prevent crashing the engine.
     userFunctionInvoker(EngineEvent::OnInitialize);
     // IMPORTANT END
 
-    u64 frameBegin = SDL_GetPerformanceCounter();
-    u64 perfFreq = SDL_GetPerformanceFrequency();
-
-    float targetDeltaTime = Application::secondsPerFrame;
-    float deltaTime = 0.0f;
+    FramePacer pacer;
 
     float prevw = float(+Window::width), prevh = float(+Window::height);
 
@@ -208,104 +338,198 @@ void CoreEngine::internalLoop()
     userFunctionInvoker([] { EngineEvent::OnWindowResize(glm::i32vec2 { Window::width, Window::height }); });
     // IMPORTANT END
 
+    size_t frameCommandListIndex = 0;
+    std::vector<InputRecord> inputRecords;
+
+    // A component's render offload, in the order components are visited in.
+    struct RenderOffloadItem
+    {
+        ComponentID id;
+        Entity* entity;
+        const std::shared_ptr<void>* component;
+    };
+    std::vector<RenderOffloadItem> renderOffloadItems;
+    // Handlers of a component type, resolved on the main thread before the offload so workers only ever index into this.
+    struct RenderOffloadDispatch
+    {
+        std::type_index type = typeid(void);
+        FuncPtrEvent<Entity&, void*, ssz>* forward = nullptr;
+        FuncPtrEvent<Entity&, void*, ssz>* late = nullptr;
+        bool handled = false;
+    };
+    std::vector<RenderOffloadDispatch> renderOffloadDispatch;
+
     func::function<void()> job;
     while (!CoreEngine::state[size_t(EngineState::ExitRequested)].test())
     {
-        deltaTime = float(SDL_GetPerformanceCounter() - frameBegin) / float(perfFreq);
+        FramePacer::Clock::time_point now = FramePacer::Clock::now();
         if (Application::mainThreadQueue.try_dequeue(job))
+        {
+            _fw_profile_zone("Main Thread Job");
             job();
-        else if (deltaTime >= targetDeltaTime)
+        }
+        else if (now >= pacer.nextDeadline())
         {
+            Profiler::beginFrame();
+            _fw_profile_zone("Frame");
+
+            bool missedDeadline;
+            FramePacer::Clock::duration period =
+                CoreEngine::runOptions.uncapped ? FramePacer::Clock::duration::zero() : FramePacer::period(Application::secondsPerFrame, float(+Screen::refreshRate()));
+            float deltaTime = pacer.beginFrame(now, period, missedDeadline);
+            Time::frameDeltaTime = deltaTime * Time::timeScale;
+            Entities::advanceFrameChangeVersion();
+
 #pragma region Input Events!
-            for (uint_fast16_t i = 0; i < uint_fast16_t(MouseButton::Count); i++)
             {
-                if (Input::heldMouseInputs[i])
+                _fw_profile_zone("Input Events");
+                CoreEngine::dispatchInput(inputRecords);
+
+                // Only what's held is visited, rather than every button and key.
+                Input::heldMouseButtons.forEach([](MouseButton button)
                 {
                     // IMPORTANT: A userlevel function block needs to be guarded with `userFunctionInvoker(...)` to catch exceptions and prevent crashing the engine.
-                    userFunctionInvoker([&i] { EngineEvent::OnMouseHeld(MouseButton(i)); });
+                    userFunctionInvoker([&button] { EngineEvent::OnMouseHeld(button); });
                     // IMPORTANT END
-                }
-            }
-            for (uint_fast16_t i = 0; i < uint_fast16_t(Key::Count); i++)
-            {
-                if (Input::heldKeyInputs[i])
+                });
+                Input::heldKeys.forEach([](Key key)
                 {
                     // IMPORTANT: A userlevel function block needs to be guarded with `userFunctionInvoker(...)` to catch exceptions and prevent crashing the engine.
-                    userFunctionInvoker([&i] { EngineEvent::OnKeyHeld(Key(i)); });
+                    userFunctionInvoker([&key] { EngineEvent::OnKeyHeld(key); });
                     // IMPORTANT END
-                }
+                });
             }
 #pragma endregion
 
 #pragma region Update RectTransform Components with Anchors
-            for (Entity& entity : Entities::range())
             {
-                if (std::shared_ptr<RectTransform> rectTransform = entity.getComponent<RectTransform>(); rectTransform && (Window::width != prevw || Window::height != prevh))
+                _fw_profile_zone("Anchor Updates");
+                if (Window::width != prevw || Window::height != prevh)
                 {
-                    RectFloat rectAnchor = rectTransform->rectAnchor();
                     RectFloat delta((Window::height - prevh) * 0.5f, (Window::width - prevw) * 0.5f, (Window::height - prevh) * -0.5f, (Window::width - prevw) * -0.5f);
-                    if (rectAnchor != RectFloat(0.0f))
-                        rectTransform->rect += delta * rectAnchor;
-
-                    RectFloat positionAnchor = rectTransform->positionAnchor();
-                    if (positionAnchor != RectFloat(0.0f))
-                        rectTransform->position += glm::vec2(delta.right, delta.top) * glm::vec2(positionAnchor.right, positionAnchor.top) +
-                            glm::vec2(delta.left, delta.bottom) * glm::vec2(positionAnchor.left, positionAnchor.bottom);
+                    for (Entity& entity : Entities::range())
+                    {
+                        std::shared_ptr<RectTransform> rectTransform = entity.getComponent<RectTransform>();
+                        if (!rectTransform)
+                            continue;
+
+                        RectFloat rectAnchor = rectTransform->rectAnchor();
+                        if (rectAnchor != RectFloat(0.0f))
+                            rectTransform->rect += delta * rectAnchor;
+
+                        RectFloat positionAnchor = rectTransform->positionAnchor();
+                        if (positionAnchor != RectFloat(0.0f))
+                            rectTransform->position += glm::vec2(delta.right, delta.top) * glm::vec2(positionAnchor.right, positionAnchor.top) +
+                                glm::vec2(delta.left, delta.bottom) * glm::vec2(positionAnchor.left, positionAnchor.bottom);
+                    }
                 }
             }
 #pragma endregion
 
             // IMPORTANT: A userlevel function block needs to be guarded with `userFunctionInvoker(...)` to catch exceptions and prevent crashing the engine.
-            userFunctionInvoker(EngineEvent::OnTick);
-            userFunctionInvoker(EngineEvent::OnLateTick);
+            {
+                _fw_profile_zone("OnTick");
+                userFunctionInvoker(EngineEvent::OnTick);
+            }
+            {
+                _fw_profile_zone("OnLateTick");
+                userFunctionInvoker(EngineEvent::OnLateTick);
+            }
+            // Sync point for structural changes recorded off the main thread, or mid-traversal.
+            {
+                _fw_profile_zone("Entity Commands");
+                userFunctionInvoker(EntityCommandBuffer::playbackSubmitted);
+            }
             // IMPORTANT END
 
 #pragma region Render Offload
             // My code is held together with glue and duct tape. And not the good stuff either.
-
-            if (Window::width != prevw || Window::height != prevh)
             {
-                CoreEngine::queueRenderJobForFrame([w = Window::width, h = Window::height]
+                _fw_profile_zone("Render Offload");
+
+                if (Window::width != prevw || Window::height != prevh)
                 {
-                    RenderPipeline::resetBackbuffer(+u32(w), +u32(h));
-                    RenderPipeline::resetViewArea(+u16(w), +u16(h));
-                });
-            }
+                    // Only the latest size matters, so a resize still waiting in the queue is superseded by this one.
+                    CoreEngine::queueRenderJobForFrame([w = Window::width, h = Window::height]
+                    {
+                        RenderPipeline::resetBackbuffer(+u32(w), +u32(h));
+                        RenderPipeline::resetViewArea(+u16(w), +u16(h));
+                    }, true, RenderJobKey { .owner = &CoreEngine::wind });
+                }
 
-            // This is a trade-off between stutter and microstutter. Higher values reduce stutter but increase latency and microstutter, lower values do the opposite.
-            if (CoreEngine::framesInFlight < Config::MaxFramesInFlight) // Don't let the CPU get too far ahead of the GPU.
-            {
-                CoreEngine::queueRenderJobForFrame([]
+                // This is a trade-off between stutter and microstutter. Higher values reduce stutter but increase latency and microstutter, lower values do the opposite.
+                if (CoreEngine::framesInFlight < Config::MaxFramesInFlight) // Don't let the CPU get too far ahead of the GPU.
                 {
+                    // At most `MaxFramesInFlight - 1` other lists are in flight, so the next list round-robin is always free to record into.
+                    RenderCommandList& commandList = CoreEngine::frameCommandLists[frameCommandListIndex];
+                    frameCommandListIndex = (frameCommandListIndex + 1) % std::size(CoreEngine::frameCommandLists);
                     CoreEngine::framesInFlight++;
-                    RenderPipeline::clearViewArea();
-                });
 
-                ssz renderIndex = 0;
-                Entities::forEachEntity([&](Entity& entity)
-                {
-                    for (auto& [typeIndex, componentSet] : Entities::table)
+                    // Flatten the offload into visiting order first, so every component knows its render index up front: the forward pass counts up from zero, the late
+                    // pass, in reverse, counts back down.
+                    // Components no handler wants are left out entirely.
+                    bool dynamicHandled = !InternalEngineEvent::OnRenderOffloadForComponent.unhandled() || !InternalEngineEvent::OnLateRenderOffloadForComponent.unhandled();
+                    for (ComponentID id = ComponentID(renderOffloadDispatch.size()); id < Entities::table.size(); id++)
                     {
-                        auto componentIt = componentSet.find(&entity);
-                        if (componentIt != componentSet.end())
-                            userFunctionInvoker([&] { InternalEngineEvent::OnRenderOffloadForComponent(typeIndex, entity, componentIt->second, renderIndex++); });
+                        renderOffloadDispatch.emplace_back(RenderOffloadDispatch { .type = ComponentRegistry::typeOf(id),
+                                                                                   .forward = &InternalEngineEvent::OnRenderOffloadFor(id),
+                                                                                   .late = &InternalEngineEvent::OnLateRenderOffloadFor(id) });
                     }
-                });
-                Entities::forEachEntityReversed([&](Entity& entity)
-                {
-                    for (auto& [typeIndex, componentSet] : Entities::table)
+                    for (RenderOffloadDispatch& dispatch : renderOffloadDispatch) dispatch.handled = dynamicHandled || !dispatch.forward->unhandled() || !dispatch.late->unhandled();
+
+                    renderOffloadItems.clear();
+                    // Handlers read transform matrices from every worker at once, so any a handler could lazily compute are resolved here, on the main thread.
+                    ComponentSet* rectTransforms = Entities::componentSet(componentID<RectTransform>());
+                    auto collectOffloadItems = [&](Entity& entity)
                     {
-                        auto componentIt = componentSet.find(&entity);
-                        if (componentIt != componentSet.end())
-                            userFunctionInvoker([&] { InternalEngineEvent::OnLateRenderOffloadForComponent(typeIndex, entity, componentIt->second, --renderIndex); });
-                    }
-                });
+                        for (ComponentID id = 0; id < Entities::table.size(); id++)
+                        {
+                            if (!Entities::table[id] || !renderOffloadDispatch[id].handled)
+                                continue;
+                            if (const std::shared_ptr<void>* component = Entities::table[id]->find(&entity))
+                                renderOffloadItems.emplace_back(RenderOffloadItem { .id = id, .entity = &entity, .component = component });
+                        }
+                    };
+                    Entities::forEachEntity([&](Entity& entity)
+                    {
+                        if (rectTransforms)
+                        {
+                            if (const std::shared_ptr<void>* rectTransform = rectTransforms->find(&entity))
+                                static_cast<RectTransform*>(rectTransform->get())->resolveMatrix();
+                        }
+                        collectOffloadItems(entity);
+                    });
+                    size_t forwardItems = renderOffloadItems.size();
+                    Entities::forEachEntityReversed(collectOffloadItems);
 
-                CoreEngine::queueRenderJobForFrame([]
-                {
-                    RenderPipeline::renderFrame();
-                    CoreEngine::framesInFlight--;
-                });
+                    // Then split it into contiguous runs across the workers, each recording into its own buffer. Buffers execute in list order, which is visiting order.
+                    commandList.resize((renderOffloadItems.size() + Config::RenderOffloadGrain - 1) / Config::RenderOffloadGrain);
+                    Scheduler::parallelFor(0, renderOffloadItems.size(), Config::RenderOffloadGrain, [&](size_t begin, size_t end)
+                    {
+                        _fw_profile_zone("Render Offload Task");
+                        threadRecordingCommandBuffer = &commandList[begin / Config::RenderOffloadGrain];
+                        for (size_t i = begin; i < end; i++)
+                        {
+                            const RenderOffloadItem& item = renderOffloadItems[i];
+                            const RenderOffloadDispatch& dispatch = renderOffloadDispatch[item.id];
+                            bool late = i >= forwardItems;
+                            ssz renderIndex = ssz(ptrdiff_t(late ? 2 * forwardItems - 1 - i : i));
+                            auto& dynamicEvent = late ? InternalEngineEvent::OnLateRenderOffloadForComponent : InternalEngineEvent::OnRenderOffloadForComponent;
+                            FuncPtrEvent<Entity&, void*, ssz>& typedEvent = late ? *dispatch.late : *dispatch.forward;
+
+                            // The `std::type_index` events are the slow path, only pay for the reference they take if anything handles them.
+                            // Handlers aren't allowed to modify these events, so they're raised from every worker at once without guarding against it.
+                            if (!dynamicEvent.unhandled())
+                                userFunctionInvoker([&] { dynamicEvent.raiseConcurrently(dispatch.type, *item.entity, *item.component, renderIndex); });
+                            if (!typedEvent.unhandled())
+                                userFunctionInvoker([&] { typedEvent.raiseConcurrently(*item.entity, item.component->get(), renderIndex); });
+                        }
+                        threadRecordingCommandBuffer = nullptr;
+                    });
+
+                    CoreEngine::renderQueue.emplace(RenderJob::frame(commandList));
+                    CoreEngine::renderThreadParker.unpark();
+                }
             }
 #pragma endregion
 
@@ -314,29 +538,42 @@ void CoreEngine::internalLoop()
             prevw = float(+Window::width);
             prevh = float(+Window::height);
 
-            frameBegin = SDL_GetPerformanceCounter();
-            targetDeltaTime = std::max(Application::secondsPerFrame - (deltaTime - targetDeltaTime), 0.0f);
-            Time::frameDeltaTime = deltaTime * Time::timeScale;
+            Time::recordFrame(deltaTime, missedDeadline);
+            if (CoreEngine::runOptions.frameLimit && Time::frameCount >= CoreEngine::runOptions.frameLimit)
+            {
+                CoreEngine::state[size_t(EngineState::ExitRequested)].test_and_set();
+                CoreEngine::state[size_t(EngineState::ExitRequested)].notify_all();
+            }
+        }
+        else // Sleep until the next frame is due, or a job arrives. Sleep through the bulk of the wait and spin the rest, since OS sleeps overshoot.
+        {
+            (void)Application::mainThreadParker.parkUntilPrecise(pacer.nextDeadline(), Config::FramePacingSpinThreshold);
+            Time::recordThreadIdle(EngineThread::Main, FramePacer::Clock::now() - now);
         }
-        else
-            CoreEngine::waitSome(std::chrono::nanoseconds(uint64_t((targetDeltaTime - (float(SDL_GetPerformanceCounter() - frameBegin) / float(perfFreq))) * 1000000000.0f)));
     }
 
     while (Application::mainThreadQueue.try_dequeue(job));
 
     userFunctionInvoker(EngineEvent::OnQuit);
 
-    Entities::front->clear();
-    Entities::front.reset();
+    EntityCommandBuffer::discardSubmitted();
+
+    while (Entity* entity = Entities::atOrNull(Entities::front)) entity->destroy();
 
-    if (!Entities::table.empty()) [[unlikely]]
+    if (std::ranges::any_of(Entities::table, [](auto& componentSet) { return componentSet && !componentSet->empty(); })) [[unlikely]]
     {
         Debug::logError("Entities weren't fully cleaned up! This will cause problems!");
-        Entities::table.clear();
+        for (std::unique_ptr<QueryCache>& cache : Entities::queries) cache->clear();
+        for (std::unique_ptr<ComponentSet>& componentSet : Entities::table)
+        {
+            if (componentSet)
+                componentSet->clear();
+        }
     }
 
     CoreEngine::state[size_t(EngineState::MainThreadDone)].test_and_set();
     CoreEngine::state[size_t(EngineState::MainThreadDone)].notify_all();
+    CoreEngine::renderThreadParker.unpark();
 }
 
 void CoreEngine::internalWindowLoop()
@@ -351,6 +588,10 @@ void CoreEngine::internalWindowLoop()
         CoreEngine::state[size_t(EngineState::RenderInit)].notify_all();
     };
 
+    // Offscreen still creates real (invisible) windows and displays, dummy is the fallback for SDL builds without it.
+    if (CoreEngine::runOptions.headless)
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen,dummy");
+
     if (!SDL_InitSubSystem(SDL_INIT_VIDEO)) [[unlikely]]
     {
         Debug::logError("Display initialisation failed! Error: ", SDL_GetError(), ".\n");
@@ -358,7 +599,21 @@ void CoreEngine::internalWindowLoop()
         goto EarlyReturn;
     }
 
-    if (!(CoreEngine::displMd = SDL_GetDesktopDisplayMode(SDL_GetPrimaryDisplay())))
+    CoreEngine::windowWakeEventType.store(SDL_RegisterEvents(1), std::memory_order_release);
+
+    if ((CoreEngine::displMd = SDL_GetDesktopDisplayMode(SDL_GetPrimaryDisplay())))
+    {
+        Screen::width = CoreEngine::displMd->w;
+        Screen::height = CoreEngine::displMd->h;
+        Screen::screenRefreshRate = CoreEngine::displMd->refresh_rate;
+    }
+    else if (CoreEngine::runOptions.headless) // Headless video drivers may not report a display, pretend the window fills one of unknown refresh rate.
+    {
+        Screen::width = Window::width;
+        Screen::height = Window::height;
+        Screen::screenRefreshRate = 0;
+    }
+    else
     {
         Debug::logError("Failed to get desktop display details: ", SDL_GetError());
         SDL_QuitSubSystem(SDL_INIT_VIDEO);
@@ -366,10 +621,6 @@ void CoreEngine::internalWindowLoop()
         goto EarlyReturn;
     }
 
-    Screen::width = CoreEngine::displMd->w;
-    Screen::height = CoreEngine::displMd->h;
-    Screen::screenRefreshRate = CoreEngine::displMd->refresh_rate;
-
     CoreEngine::wind = SDL_CreateWindow(Window::_name.c_str(), +Window::width, +Window::height, SDL_WINDOW_HIGH_PIXEL_DENSITY);
     if (!CoreEngine::wind)
     {
@@ -395,12 +646,16 @@ void CoreEngine::internalWindowLoop()
         {
             decltype(resizeData)& windowSizeData = *_as(decltype(resizeData)*, data);
 
+            // Watchers run on whichever thread pushes the event, only the window thread gets to run window thread jobs.
+            if (windowSizeData.mustBe != std::this_thread::get_id())
+                return 0;
+
             while (Application::windowThreadQueue.try_dequeue(windowSizeData.job)) windowSizeData.job();
 
             if (windowSizeData.mustBe == std::this_thread::get_id() && windowSizeData.shouldUnlock.test())
             {
                 windowSizeData.shouldUnlock.clear();
-                CoreEngine::renderQueueLock.unlock();
+                CoreEngine::renderThreadLock.unlock();
             }
             if (event->type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED)
             {
@@ -417,7 +672,7 @@ void CoreEngine::internalWindowLoop()
                     userFunctionInvoker([&prevw, &prevh] { EngineEvent::OnWindowResize(glm::i32vec2 { prevw, prevh }); });
                 });
 
-                CoreEngine::renderQueueLock.lock();
+                CoreEngine::renderThreadLock.lock();
                 windowSizeData.shouldUnlock.test_and_set();
             }
 
@@ -431,10 +686,15 @@ void CoreEngine::internalWindowLoop()
         CoreEngine::state[size_t(EngineState::RenderInit)].test_and_set(); // Spin off rendering thread.
         CoreEngine::state[size_t(EngineState::RenderInit)].notify_all();
 
+        Time::recordThreadStart(EngineThread::Window);
+        Profiler::setThreadName("Window");
+
         SDL_Event ev;
         while (!CoreEngine::state[size_t(EngineState::RenderThreadDone)].test())
         {
+            CoreEngine::windowWakePending.clear();
             while (Application::windowThreadQueue.try_dequeue(job)) job();
+            bool inputHeldBack = !Input::flushInputOverflow();
 
             if (SDL_PeepEvents(&ev, 1, SDL_PEEKEVENT, SDL_EVENT_FIRST, SDL_EVENT_LAST) && ev.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED)
             {
@@ -443,10 +703,10 @@ void CoreEngine::internalWindowLoop()
                 if (resizeData.shouldUnlock.test())
                 {
                     resizeData.shouldUnlock.clear();
-                    CoreEngine::renderQueueLock.unlock();
+                    CoreEngine::renderThreadLock.unlock();
                 }
 
-                std::lock_guard guard(CoreEngine::renderQueueLock);
+                std::lock_guard guard(CoreEngine::renderThreadLock);
                 SDL_PollEvent(&ev);
             }
             else if (SDL_PollEvent(&ev))
@@ -455,55 +715,32 @@ void CoreEngine::internalWindowLoop()
                 {
 #pragma region Mouse Events
                 case SDL_EVENT_MOUSE_MOTION:
-                    Application::queueJobForMainThread([xPos = ev.motion.x, yPos = ev.motion.y, xMot = ev.motion.xrel, yMot = ev.motion.yrel]
-                    {
-                        glm::vec2 from = Input::internalMousePosition;
-                        Input::internalMousePosition.x = xPos - Window::width / 2_u32;
-                        Input::internalMousePosition.y = -yPos + Window::height / 2_u32;
-                        Input::internalMouseMotion.x += xMot;
-                        Input::internalMouseMotion.y -= yMot;
-                        userFunctionInvoker([&from] { EngineEvent::OnMouseMove(from); });
-                    });
+                    Input::queueInputRecord(InputRecord { .type = InputRecordType::MouseMove,
+                                                          .timestamp = ev.motion.timestamp,
+                                                          .mouseMove { .x = ev.motion.x, .y = ev.motion.y, .xMotion = ev.motion.xrel, .yMotion = ev.motion.yrel } });
                     break;
                 case SDL_EVENT_MOUSE_WHEEL:
-                    Application::queueJobForMainThread([xScr = ev.wheel.x, yScr = ev.wheel.y]
-                    { userFunctionInvoker([&xScr, &yScr] { EngineEvent::OnMouseScroll(glm::vec2(xScr, yScr)); }); });
+                    Input::queueInputRecord(
+                        InputRecord { .type = InputRecordType::MouseScroll, .timestamp = ev.wheel.timestamp, .mouseScroll { .x = ev.wheel.x, .y = ev.wheel.y } });
                     break;
                 case SDL_EVENT_MOUSE_BUTTON_DOWN:
-                    Application::queueJobForMainThread([button = Input::convertFromSDLMouse(ev.button.button)]
-                    {
-                        Input::heldMouseInputs[size_t(button)] = true;
-                        userFunctionInvoker([&button] { EngineEvent::OnMouseDown(button); });
-                    });
+                    Input::queueInputRecord(
+                        InputRecord { .type = InputRecordType::MouseDown, .timestamp = ev.button.timestamp, .button = Input::convertFromSDLMouse(ev.button.button) });
                     break;
                 case SDL_EVENT_MOUSE_BUTTON_UP:
-                    Application::queueJobForMainThread([button = Input::convertFromSDLMouse(ev.button.button)]
-                    {
-                        Input::heldMouseInputs[size_t(button)] = false;
-                        userFunctionInvoker([&button] { EngineEvent::OnMouseUp(button); });
-                    });
+                    Input::queueInputRecord(
+                        InputRecord { .type = InputRecordType::MouseUp, .timestamp = ev.button.timestamp, .button = Input::convertFromSDLMouse(ev.button.button) });
                     break;
 #pragma endregion
 
 #pragma region Key Events
                 case SDL_EVENT_KEY_DOWN:
-                    if (ev.key.repeat)
-                        Application::queueJobForMainThread([key = Input::convertFromSDLKey(ev.key.key)] { userFunctionInvoker([&key] { EngineEvent::OnKeyRepeat(key); }); });
-                    else
-                    {
-                        Application::queueJobForMainThread([key = Input::convertFromSDLKey(ev.key.key)]
-                        {
-                            Input::heldKeyInputs[size_t(key)] = true;
-                            userFunctionInvoker([&key] { EngineEvent::OnKeyDown(key); });
-                        });
-                    }
+                    Input::queueInputRecord(InputRecord { .type = ev.key.repeat ? InputRecordType::KeyRepeat : InputRecordType::KeyDown,
+                                                          .timestamp = ev.key.timestamp,
+                                                          .key = Input::convertFromSDLKey(ev.key.key) });
                     break;
                 case SDL_EVENT_KEY_UP:
-                    Application::queueJobForMainThread([key = Input::convertFromSDLKey(ev.key.key)]
-                    {
-                        Input::heldKeyInputs[size_t(key)] = false;
-                        userFunctionInvoker([&key] { EngineEvent::OnKeyUp(key); });
-                    });
+                    Input::queueInputRecord(InputRecord { .type = InputRecordType::KeyUp, .timestamp = ev.key.timestamp, .key = Input::convertFromSDLKey(ev.key.key) });
                     break;
 #pragma endregion
 
@@ -531,7 +768,16 @@ void CoreEngine::internalWindowLoop()
                             else
                                 input.push_back(char32_t(*it)); // 1 byte.
                         }
-                        Application::queueJobForMainThread([input = std::move(input)] { userFunctionInvoker([&input] { EngineEvent::OnTextInput(input); }); });
+
+                        // Goes through the input buffer too, to stay in order with key events.
+                        for (size_t i = 0; i < input.size(); i += InputRecord::TextCapacity)
+                        {
+                            InputRecord record { .type = InputRecordType::TextInput, .timestamp = ev.text.timestamp, .textInput {} };
+                            record.textInput.length = uint_fast8_t(std::min(input.size() - i, InputRecord::TextCapacity));
+                            record.textInput.continues = i > 0;
+                            std::copy_n(input.data() + i, record.textInput.length, record.textInput.text);
+                            Input::queueInputRecord(record);
+                        }
                     }
                     break;
 
@@ -542,11 +788,18 @@ void CoreEngine::internalWindowLoop()
                 case SDL_EVENT_QUIT:
                     CoreEngine::state[size_t(EngineState::ExitRequested)].test_and_set();
                     CoreEngine::state[size_t(EngineState::ExitRequested)].notify_all();
+                    Application::mainThreadParker.unpark();
                     break;
                 }
             }
-            else
-                CoreEngine::waitSome();
+            else // Sleep until there's an event, including the wake-up event `Application::notifyWindowThread` pushes.
+            {
+                // Input held back is retried soon, rather than waiting on an event that may not come.
+                std::chrono::steady_clock::time_point waitBegin = std::chrono::steady_clock::now();
+                std::chrono::milliseconds timeout = inputHeldBack ? Config::InputOverflowRetryInterval : Config::WindowThreadWaitTimeout;
+                (void)SDL_WaitEventTimeout(nullptr, int32_t(timeout.count()));
+                Time::recordThreadIdle(EngineThread::Window, std::chrono::steady_clock::now() - waitBegin);
+            }
         }
 
         SDL_DestroyWindow(CoreEngine::wind);
@@ -570,27 +823,6 @@ void CoreEngine::internalRenderLoop()
     }
 
     {
-        RendererBackend initBackend = RendererBackend::Default;
-        const RendererBackend backendPriorityOrder[] {
-#if _WIN32
-            RendererBackend::Vulkan, RendererBackend::Direct3D12, RendererBackend::Direct3D11, RendererBackend::OpenGL,
-#else
-            RendererBackend::Vulkan, RendererBackend::OpenGL,
-#endif
-            RendererBackend::Default
-        };
-
-        std::vector<RendererBackend> vecBackends = Renderer::platformBackends();
-        std::set<RendererBackend> backends(vecBackends.begin(), vecBackends.end());
-        for (RendererBackend targetBackend : backendPriorityOrder)
-        {
-            if (backends.contains(targetBackend))
-            {
-                initBackend = targetBackend;
-                break;
-            }
-        }
-
         constexpr auto notifyEarlyFailure = []
         {
             CoreEngine::state[size_t(EngineState::ExitRequested)].test_and_set();
@@ -599,44 +831,69 @@ void CoreEngine::internalRenderLoop()
             CoreEngine::state[size_t(EngineState::RenderThreadReady)].notify_all();
         };
 
+        RendererBackend initBackend = RendererBackend::NoOp;
         void *nwh = nullptr, *ndt = nullptr;
+        if (!CoreEngine::runOptions.headless) // Headless runs present nothing, so they need neither a real backend nor a native window.
+        {
+            initBackend = RendererBackend::Default;
+            const RendererBackend backendPriorityOrder[] {
+#if _WIN32
+                RendererBackend::Vulkan, RendererBackend::Direct3D12, RendererBackend::Direct3D11, RendererBackend::OpenGL,
+#else
+                RendererBackend::Vulkan, RendererBackend::OpenGL,
+#endif
+                RendererBackend::Default
+            };
+
+            std::vector<RendererBackend> vecBackends = Renderer::platformBackends();
+            std::set<RendererBackend> backends(vecBackends.begin(), vecBackends.end());
+            for (RendererBackend targetBackend : backendPriorityOrder)
+            {
+                if (backends.contains(targetBackend))
+                {
+                    initBackend = targetBackend;
+                    break;
+                }
+            }
+
 #if defined(SDL_PLATFORM_WIN32)
-        nwh = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_WIN32_HWND_POINTER, nullptr);
+            nwh = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_WIN32_HWND_POINTER, nullptr);
 #elif defined(SDL_PLATFORM_MACOS)
-        nwh = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_COCOA_WINDOW_POINTER, nullptr);
+            nwh = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_COCOA_WINDOW_POINTER, nullptr);
 #elif defined(SDL_PLATFORM_LINUX)
-        if (SDL_strcmp(SDL_GetCurrentVideoDriver(), "x11") == 0)
-        {
-            ndt = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_X11_DISPLAY_POINTER, nullptr);
-            nwh = _asr(void*, SDL_GetNumberProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_X11_WINDOW_NUMBER, 0));
-        }
-        else if (SDL_strcmp(SDL_GetCurrentVideoDriver(), "wayland") == 0)
-        {
-            ndt = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_WAYLAND_DISPLAY_POINTER, nullptr);
-            nwh = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_WAYLAND_SURFACE_POINTER, nullptr);
-        }
-        else
-        {
-            Debug::logError("Invalid Linux video driver!");
-            notifyEarlyFailure();
-            goto EarlyReturn;
-        }
+            if (SDL_strcmp(SDL_GetCurrentVideoDriver(), "x11") == 0)
+            {
+                ndt = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_X11_DISPLAY_POINTER, nullptr);
+                nwh = _asr(void*, SDL_GetNumberProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_X11_WINDOW_NUMBER, 0));
+            }
+            else if (SDL_strcmp(SDL_GetCurrentVideoDriver(), "wayland") == 0)
+            {
+                ndt = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_WAYLAND_DISPLAY_POINTER, nullptr);
+                nwh = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_WAYLAND_SURFACE_POINTER, nullptr);
+            }
+            else
+            {
+                Debug::logError("Invalid Linux video driver!");
+                notifyEarlyFailure();
+                goto EarlyReturn;
+            }
 
-        if (!ndt)
-        {
-            Debug::logError("Failed to get Linux display!");
-            notifyEarlyFailure();
-            goto EarlyReturn;
-        }
+            if (!ndt)
+            {
+                Debug::logError("Failed to get Linux display!");
+                notifyEarlyFailure();
+                goto EarlyReturn;
+            }
 #elif defined(SDL_PLATFORM_IOS)
-        nwh = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_UIKIT_WINDOW_POINTER, nullptr);
+            nwh = SDL_GetPointerProperty(SDL_GetWindowProperties(CoreEngine::wind), SDL_PROP_WINDOW_UIKIT_WINDOW_POINTER, nullptr);
 #endif
 
-        if (!nwh)
-        {
-            Debug::logError("Failed to get window handle!");
-            notifyEarlyFailure();
-            goto EarlyReturn;
+            if (!nwh)
+            {
+                Debug::logError("Failed to get window handle!");
+                notifyEarlyFailure();
+                goto EarlyReturn;
+            }
         }
 
         if (!RenderPipeline::renderInitialize(ndt, nwh, u32(Window::width), u32(Window::height), initBackend))
@@ -650,35 +907,85 @@ void CoreEngine::internalRenderLoop()
     CoreEngine::state[size_t(EngineState::RenderThreadReady)].test_and_set(); // Signal main thread.
     CoreEngine::state[size_t(EngineState::RenderThreadReady)].notify_all();
 
+    Time::recordThreadStart(EngineThread::Render);
+    Profiler::setThreadName("Render");
+
     {
-        RenderJob job;
+        std::vector<RenderJob> batch;
+        robin_hood::unordered_flat_map<RenderJobKey, size_t, RenderJobKey::Hash> latestByKey;
         while (!CoreEngine::state[size_t(EngineState::MainThreadDone)].test())
         {
-        WhileLoop:
+            // Producers never wait on the render thread, the queue is only drained here. The lock only exists to let the window thread stall rendering mid-resize.
+            if (CoreEngine::renderQueue.tryDequeueBulk(batch))
             {
-                std::lock_guard guard(CoreEngine::renderQueueLock);
-                if (!CoreEngine::renderQueue.empty())
+                std::lock_guard guard(CoreEngine::renderThreadLock);
+
+                // A frame weighs as much as the commands recorded into it, so the backlog is measured the same whether jobs were recorded or queued directly.
+                auto weight = [](const RenderJob& job) -> size_t { return job.frame() ? std::max(job.frame()->size(), size_t(1)) : 1; };
+
+                size_t backlog = CoreEngine::renderQueue.sizeApprox();
+                size_t latestFrame = batch.size();
+                latestByKey.clear();
+                for (size_t i = 0; i < batch.size(); i++)
                 {
-                    job = std::move(CoreEngine::renderQueue.front());
-                    CoreEngine::renderQueue.pop_front();
-                    if (CoreEngine::renderQueue.size() >= Config::GraphicsQueueOverburdenedThreshold && !job.required())
-                        Debug::logInfo("Render queue overburdened, skipping render job id ", static_cast<const void*>(&job.function()), ".\n");
+                    backlog += weight(batch[i]);
+                    if (batch[i].frame())
+                        latestFrame = i;
+                    if (batch[i].key())
+                        latestByKey[batch[i].key()] = i;
+                }
+
+                uint64_t dropped = 0, droppedFrames = 0, coalesced = 0;
+                for (size_t i = 0; i < batch.size(); i++)
+                {
+                    backlog -= weight(batch[i]);
+                    bool overburdened = backlog >= Config::GraphicsQueueOverburdenedThreshold;
+
+                    if (batch[i].key() && latestByKey[batch[i].key()] != i)
+                        ++coalesced;
+                    else if (RenderCommandList* frame = batch[i].frame())
+                    {
+                        // Frames are shed whole, never torn: a frame with a newer one behind it is dropped entirely while overburdened.
+                        bool stale = overburdened && i < latestFrame;
+                        droppedFrames += stale;
+                        CoreEngine::executeFrame(*frame, stale);
+                    }
+                    else if (overburdened && !batch[i].required())
+                        ++dropped;
                     else
-                        job();
-                    goto WhileLoop;
+                    {
+                        _fw_profile_zone("Render Job");
+                        batch[i]();
+                    }
                 }
+                batch.clear();
+
+                if (dropped)
+                    CoreEngine::droppedRenderJobs.fetch_add(dropped, std::memory_order_relaxed);
+                if (droppedFrames)
+                    CoreEngine::droppedFrames.fetch_add(droppedFrames, std::memory_order_relaxed);
+                if (coalesced)
+                    CoreEngine::coalescedRenderJobs.fetch_add(coalesced, std::memory_order_relaxed);
+            }
+            else
+            {
+                std::chrono::steady_clock::time_point waitBegin = std::chrono::steady_clock::now();
+                CoreEngine::renderThreadParker.park(Config::ParkSpinDuration);
+                Time::recordThreadIdle(EngineThread::Render, std::chrono::steady_clock::now() - waitBegin);
             }
-
-            CoreEngine::waitSome();
         }
 
         // Cleanup.
-        while (!CoreEngine::renderQueue.empty())
+        while (CoreEngine::renderQueue.tryDequeueBulk(batch))
         {
-            job = std::move(CoreEngine::renderQueue.front());
-            CoreEngine::renderQueue.pop_front();
-            if (job.required())
-                job();
+            for (RenderJob& job : batch)
+            {
+                if (RenderCommandList* frame = job.frame())
+                    CoreEngine::executeFrame(*frame, true);
+                else if (job.required())
+                    job();
+            }
+            batch.clear();
         }
     }
 
@@ -687,4 +994,5 @@ void CoreEngine::internalRenderLoop()
 EarlyReturn:
     CoreEngine::state[size_t(EngineState::RenderThreadDone)].test_and_set(); // Signal window thread.
     CoreEngine::state[size_t(EngineState::RenderThreadDone)].notify_all();
+    Application::notifyWindowThread();
 }
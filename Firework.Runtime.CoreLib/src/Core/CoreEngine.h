@@ -8,17 +8,22 @@ _push_nowarn_c_cast();
 #include <atomic>
 #include <concepts>
 #include <concurrentqueue.h>
-#include <deque>
 #include <function.h>
 #include <list>
+#include <mutex>
 #include <vector>
 _pop_nowarn_c_cast();
 
+#include <Core/RenderCommandBuffer.h>
 #include <Core/RenderJob.h>
+#include <Firework/Config.h>
+#include <Library/RingQueue.h>
+#include <Library/ThreadParker.h>
 
 namespace Firework
 {
     class Application;
+    struct RunOptions;
     class Debug;
 
     class Cursor;
@@ -30,6 +35,8 @@ namespace Firework
 _push_nowarn_msvc(_clWarn_msvc_export_interface);
 namespace Firework::Internal
 {
+    struct InputRecord;
+
     /// @internal
     /// @brief Internal API. what the ~~dog~~ engine doin'
     enum class EngineState : uint_fast8_t
@@ -49,6 +56,18 @@ namespace Firework::Internal
         return std::to_underlying(a) <=> std::to_underlying(b);
     }
 
+    /// @internal
+    /// @brief Internal API. Counts of render work shed by the render thread since startup.
+    struct RenderQueueStatistics
+    {
+        /// @brief Non-required render jobs dropped because the render queue was overburdened.
+        uint64_t droppedJobs = 0;
+        /// @brief Frames dropped whole because the render queue was overburdened and a newer frame was queued.
+        uint64_t droppedFrames = 0;
+        /// @brief Render jobs and commands skipped because a newer one with the same `RenderJobKey` was queued.
+        uint64_t coalescedJobs = 0;
+    };
+
     /// @internal
     /// @brief Static class containing functionality relevant to the backend operations of the runtime.
     class _fw_core_api CoreEngine final
@@ -59,21 +78,45 @@ namespace Firework::Internal
 
         static std::atomic_flag state[size_t(EngineState::Count)];
 
-        static std::deque<RenderJob> renderQueue;
-        static std::mutex renderQueueLock;
+        static RingQueue<RenderJob, Config::RenderQueueCapacity> renderQueue;
+        /// @internal
+        /// @brief Internal API. Held by the render thread while it executes a drained batch of jobs. Never taken by producers.
+        static std::mutex renderThreadLock;
+        static ThreadParker renderThreadParker;
         static std::atomic<uint_least8_t> framesInFlight;
 
-        inline static void waitSome(std::chrono::nanoseconds durationHint = Config::UnspecifiedSleepDuration)
-        {
-            if constexpr (Config::LatencyTrade == Config::LatencyTradeSetting::ThreadYield)
-                std::this_thread::yield();
-            else if constexpr (Config::LatencyTrade == Config::LatencyTradeSetting::ThreadSleep)
-                std::this_thread::sleep_for(Config::UnspecifiedSleepDuration);
-            else // if constexpr (Config::LatencyTrade == Config::LatencyTradeSetting::None)
-            {
-                // Busy wait.
-            }
-        }
+        static RunOptions runOptions;
+
+        static std::atomic<uint64_t> droppedRenderJobs;
+        static std::atomic<uint64_t> droppedFrames;
+        static std::atomic<uint64_t> coalescedRenderJobs;
+
+        /// @internal
+        /// @brief Internal API. SDL user event type pushed to wake the window thread, zero until the window thread registers it.
+        static std::atomic<uint32_t> windowWakeEventType;
+        static std::atomic_flag windowWakePending;
+
+        /// @internal
+        /// @brief Internal API. One command list per frame that can be in flight, plus the one being recorded.
+        static RenderCommandList frameCommandLists[Config::MaxFramesInFlight + 1];
+        /// @internal
+        /// @brief Internal API. Retrieve the command buffer render jobs queued from this thread are currently recorded into.
+        /// @return The frame command buffer being recorded, or `nullptr` if this thread isn't recording part of a frame.
+        /// @note Thread-safe.
+        static RenderCommandBuffer* recordingCommandBuffer();
+
+        /// @internal
+        /// @brief Internal API. Run a frame submitted with `RenderJob::frame`, then release its command list.
+        /// @param commandList Command list the frame was recorded into.
+        /// @param stale Whether a newer frame has superseded this one. Stale frames only run their required commands and are never presented.
+        /// @note Render thread only.
+        static void executeFrame(RenderCommandList& commandList, bool stale);
+
+        /// @internal
+        /// @brief Internal API. Dispatch the input events buffered since the last frame, merging consecutive mouse motion and scroll.
+        /// @param records Scratch space, reused across frames.
+        /// @note Main thread only.
+        static void dispatchInput(std::vector<InputRecord>& records);
 
         /// @internal
         /// @brief Internal API. Update the display information.
@@ -97,11 +140,12 @@ namespace Firework::Internal
         /// @brief Internal API. Initialize and start the runtime.
         /// @param argc Forwarded from int main(...).
         /// @param argv Forwarded from int main(...).
+        /// @param options How to run. Command line flags override these, see `RunOptions`.
         /// @return Whether the runtime was able to successfully initialize.
         /// @retval - EXIT_SUCCESS: The runtime initialized successfully.
         /// @retval - EXIT_FAILURE: The runtime failed to initialize.
         /// @note Thread-safe.
-        static int execute(int argc, char* argv[]);
+        static int execute(int argc, char* argv[], const RunOptions& options);
     public:
         CoreEngine() = delete;
 
@@ -110,14 +154,26 @@ namespace Firework::Internal
         /// @tparam Func ```requires std::constructible_from<func::function<void()>, Func&&>```
         /// @param job Job to queue.
         /// @param required Whether this job has to run if the runtime is behind.
-        /// @note Thread-safe.
+        /// @param key Coalescing key. If a newer job with the same key is queued before this one runs, this one is skipped.
+        /// @note Thread-safe. Lock-free unless the render queue is full. Jobs queued from render offload handlers are recorded into the frame being offloaded instead.
         template <std::invocable<> Func>
-        inline static void queueRenderJobForFrame(Func&& job, bool required = true)
+        inline static void queueRenderJobForFrame(Func&& job, bool required = true, RenderJobKey key = {})
         {
-            std::lock_guard guard(CoreEngine::renderQueueLock);
-            CoreEngine::renderQueue.emplace_back(std::forward<Func>(job), required);
+            if (RenderCommandBuffer* commandBuffer = CoreEngine::recordingCommandBuffer())
+                commandBuffer->record(std::forward<Func>(job), required, key);
+            else
+            {
+                CoreEngine::renderQueue.emplace(std::forward<Func>(job), required, key);
+                CoreEngine::renderThreadParker.unpark();
+            }
         }
 
+        /// @internal
+        /// @brief Low-level API. Retrieve how much render work has been shed to keep up.
+        /// @return Counts of dropped and coalesced render work since startup.
+        /// @note Thread-safe.
+        static RenderQueueStatistics renderQueueStatistics();
+
         friend class Firework::Application;
         friend class Firework::Debug;
 
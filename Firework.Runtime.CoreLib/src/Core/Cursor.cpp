@@ -11,15 +11,6 @@ std::shared_ptr<CursorTexture> Cursor::currentCursor;
 CursorLockState Cursor::_lockState = CursorLockState::None;
 bool Cursor::_visible = true;
 
-Property<bool, bool> Cursor::visible { []() -> bool { return Cursor::_visible; }, [](bool value) -> void
-{
-    Cursor::setVisible(value);
-} };
-Property<CursorLockState, CursorLockState> Cursor::lockState { []() -> CursorLockState { return Cursor::_lockState; }, [](CursorLockState value) -> void
-{
-    Cursor::setLockState(value);
-} };
-
 void Cursor::setVisible(bool value)
 {
     Application::queueJobForWindowThread([value]() -> void
@@ -69,8 +69,8 @@ namespace Firework
         static void setVisible(bool value);
         static void setLockState(CursorLockState value);
     public:
-        static Property<bool, bool> visible;
-        static Property<CursorLockState, CursorLockState> lockState;
+        _fw_static_property(visible, bool, bool, &Cursor::_visible, &Cursor::setVisible);
+        _fw_static_property(lockState, CursorLockState, CursorLockState, &Cursor::_lockState, &Cursor::setLockState);
 
         static void setCursor(std::shared_ptr<CursorTexture> cursor);
 
@@ -34,18 +34,9 @@ namespace Firework
     public:
         Window() = delete;
 
-        inline static Property<const std::string&, std::string> name { []() -> const std::string& { return Window::_name; }, [](std::string value) -> void
-        {
-            Window::setName(std::move(value));
-        } };
-        inline static Property<glm::ivec2, glm::ivec2> minimumSize { []() -> glm::ivec2 { return Window::_minimumSize; }, [](const glm::ivec2 value) -> void
-        {
-            Window::setMinimumSize(value);
-        } };
-        inline static Property<bool, bool> resizable { []() -> bool { return Window::_resizable; }, [](const bool value) -> void
-        {
-            Window::setResizable(value);
-        } };
+        _fw_static_property(name, const std::string&, std::string, &Window::_name, &Window::setName);
+        _fw_static_property(minimumSize, glm::ivec2, glm::ivec2, &Window::_minimumSize, &Window::setMinimumSize);
+        _fw_static_property(resizable, bool, bool, &Window::_resizable, &Window::setResizable);
 
         /// @brief Retrieve whether the window is resizing this frame.
         /// @return Whether the window is resizing.
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+
+#include <Firework/Config.h>
+
+namespace Firework::Internal
+{
+    /// @internal
+    /// @brief Internal API. Schedules frames against absolute deadlines, so time lost to a late frame is made up by the next one rather than accumulating.
+    /// @note Main thread only.
+    class FramePacer final
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+    private:
+        Clock::time_point deadline = Clock::now();
+        Clock::time_point lastFrame = deadline;
+    public:
+        /// @internal
+        /// @brief Internal API. Compute the frame period for a target frame time, snapped to a whole number of display refreshes if it's close to one.
+        /// @param secondsPerFrame Target frame time in seconds.
+        /// @param refreshRate Display refresh rate in Hz, or zero if unknown.
+        /// @return Frame period.
+        inline static Clock::duration period(float secondsPerFrame, float refreshRate)
+        {
+            double seconds = double(secondsPerFrame);
+            if (refreshRate > 0.0f)
+            {
+                double refreshPeriod = 1.0 / double(refreshRate);
+                double refreshes = std::round(seconds / refreshPeriod);
+                if (refreshes >= 1.0 && std::abs(seconds / refreshPeriod - refreshes) <= double(Config::FramePacingSnapTolerance) * refreshes)
+                    seconds = refreshes * refreshPeriod;
+            }
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        }
+
+        /// @internal
+        /// @brief Internal API. Retrieve the deadline the next frame is due at.
+        inline Clock::time_point nextDeadline() const
+        {
+            return this->deadline;
+        }
+
+        /// @internal
+        /// @brief Internal API. Start a frame, scheduling the deadline of the next one.
+        /// @param now Time the frame started at.
+        /// @param period Frame period, from `FramePacer::period`.
+        /// @param[out] missedDeadline Whether this frame started more than half a period after it was due. Uncapped frames, with a zero period, never miss.
+        /// @return Time since the previous frame started, in seconds.
+        inline float beginFrame(Clock::time_point now, Clock::duration period, bool& missedDeadline)
+        {
+            missedDeadline = period > Clock::duration::zero() && now - this->deadline > period / 2;
+
+            // Catch up on a slightly late frame, but don't try to make up for whole frames that never happened.
+            this->deadline += period;
+            if (this->deadline <= now)
+                this->deadline = now + period;
+
+            float deltaTime = std::chrono::duration<float>(now - this->lastFrame).count();
+            this->lastFrame = now;
+            return deltaTime;
+        }
+    };
+} // namespace Firework::Internal
@@ -10,8 +10,38 @@ using namespace Firework::Internal;
 glm::vec2 Input::internalMousePosition;
 glm::vec2 Input::internalMouseMotion;
 
-bool Input::heldMouseInputs[size_t(MouseButton::Count)] {};
-bool Input::heldKeyInputs[size_t(Key::Count)] {};
+EnumMask<MouseButton> Input::heldMouseButtons;
+EnumMask<MouseButton> Input::pressedMouseButtons;
+EnumMask<MouseButton> Input::releasedMouseButtons;
+EnumMask<Key> Input::heldKeys;
+EnumMask<Key> Input::pressedKeys;
+EnumMask<Key> Input::releasedKeys;
+
+RingQueue<InputRecord, Config::InputQueueCapacity> Input::inputQueue;
+std::atomic<uint64_t> Input::droppedInputRecords = 0;
+std::vector<InputRecord> Input::inputOverflow;
+
+void Input::queueInputRecord(const InputRecord& record)
+{
+    if (Input::flushInputOverflow() && Input::inputQueue.tryEmplace(record)) [[likely]]
+        return;
+
+    // Motion and scroll are merged per frame anyway, and repeats come again, losing some only loses precision. Losing a button or key release would leave it stuck,
+    // so those are held back instead. Waiting for room would stop the window thread pumping events while the main thread is busy.
+    if (record.type == InputRecordType::MouseMove || record.type == InputRecordType::MouseScroll || record.type == InputRecordType::KeyRepeat)
+        Input::droppedInputRecords.fetch_add(1, std::memory_order_relaxed);
+    else
+        Input::inputOverflow.emplace_back(record);
+}
+bool Input::flushInputOverflow()
+{
+    _fence_value_return(true, Input::inputOverflow.empty());
+
+    size_t flushed = 0;
+    while (flushed < Input::inputOverflow.size() && Input::inputQueue.tryEmplace(Input::inputOverflow[flushed])) ++flushed;
+    Input::inputOverflow.erase(Input::inputOverflow.begin(), Input::inputOverflow.begin() + ptrdiff_t(flushed));
+    return Input::inputOverflow.empty();
+}
 
 MouseButton Input::convertFromSDLMouse(uint_fast8_t code)
 {
@@ -6,11 +6,18 @@ _push_nowarn_c_cast();
 #include <SDL3/SDL_keycode.h>
 #include <SDL3/SDL_mouse.h>
 #include <glm/vec2.hpp>
+#include <atomic>
+#include <cstdint>
 #include <queue>
 #include <robin_hood.h>
+#include <type_traits>
 #include <vector>
 _pop_nowarn_c_cast();
 
+#include <Firework/Config.h>
+#include <Library/EnumMask.h>
+#include <Library/RingQueue.h>
+
 namespace Firework::Internal
 {
     class CoreEngine;
@@ -310,15 +317,90 @@ namespace Firework
 
         Count
     };
+} // namespace Firework
+
+namespace Firework::Internal
+{
+    /// @internal
+    /// @brief Internal API. Kind of input event an `InputRecord` holds.
+    enum class InputRecordType : uint_fast8_t
+    {
+        MouseMove,
+        MouseScroll,
+        MouseDown,
+        MouseUp,
+        KeyDown,
+        KeyRepeat,
+        KeyUp,
+        TextInput
+    };
 
+    /// @internal
+    /// @brief Internal API. Input event captured by the window thread, buffered for the main thread to dispatch at the start of the next frame.
+    struct InputRecord
+    {
+        /// @brief Number of characters a single record holds. Longer text input is split across consecutive records.
+        constexpr static size_t TextCapacity = 8;
+
+        InputRecordType type;
+        /// @brief When the event happened, in SDL ticks (nanoseconds).
+        uint64_t timestamp;
+        union
+        {
+            struct
+            {
+                float x, y;
+                float xMotion, yMotion;
+            } mouseMove;
+            struct
+            {
+                float x, y;
+            } mouseScroll;
+            MouseButton button;
+            Key key;
+            struct
+            {
+                char32_t text[TextCapacity];
+                uint_fast8_t length;
+                /// @brief Whether this continues the text of the previous record, split from the same event.
+                bool continues;
+            } textInput;
+        };
+    };
+    static_assert(std::is_trivially_copyable_v<InputRecord>);
+} // namespace Firework::Internal
+
+namespace Firework
+{
     /// @brief Static class containing functionality relevant to input processing.
     class _fw_core_api Input final
     {
         static glm::vec2 internalMousePosition;
         static glm::vec2 internalMouseMotion;
 
-        static bool heldMouseInputs[size_t(MouseButton::Count)];
-        static bool heldKeyInputs[size_t(Key::Count)];
+        static EnumMask<MouseButton> heldMouseButtons;
+        static EnumMask<MouseButton> pressedMouseButtons;
+        static EnumMask<MouseButton> releasedMouseButtons;
+        static EnumMask<Key> heldKeys;
+        static EnumMask<Key> pressedKeys;
+        static EnumMask<Key> releasedKeys;
+
+        static RingQueue<Internal::InputRecord, Config::InputQueueCapacity> inputQueue;
+        static std::atomic<uint64_t> droppedInputRecords;
+        /// @brief Input events the buffer had no room for, in order, ahead of anything queued after them. Window thread only.
+        static std::vector<Internal::InputRecord> inputOverflow;
+
+        /// @internal
+        /// @brief Internal API. Buffer an input event for the main thread. If the buffer is full, mouse motion, scroll and key repeats are dropped, anything else is
+        /// held back until there's room. Never blocks.
+        /// @param record Input event to buffer.
+        /// @note Window thread only.
+        static void queueInputRecord(const Internal::InputRecord& record);
+        /// @internal
+        /// @brief Internal API. Move as many held back input events into the buffer as there's room for.
+        /// @return Whether none are left held back.
+        /// @note Window thread only.
+        static bool flushInputOverflow();
 
         /// @internal
         /// @brief Internal API. SDL mouse code to Firework::MouseButton
@@ -355,15 +437,91 @@ namespace Firework
         /// @note Main thread only.
         inline static bool mouseHeld(MouseButton button)
         {
-            return Input::heldMouseInputs[size_t(button)];
+            return Input::heldMouseButtons.test(button);
+        }
+        /// @brief Retrieve whether mouse button went down this frame.
+        /// @param button Mouse button to check.
+        /// @return Whether button went down.
+        /// @note Main thread only.
+        inline static bool mousePressed(MouseButton button)
+        {
+            return Input::pressedMouseButtons.test(button);
+        }
+        /// @brief Retrieve whether mouse button went up this frame.
+        /// @param button Mouse button to check.
+        /// @return Whether button went up.
+        /// @note Main thread only.
+        inline static bool mouseReleased(MouseButton button)
+        {
+            return Input::releasedMouseButtons.test(button);
+        }
+        /// @brief Retrieve every mouse button pressed this frame.
+        /// @note Main thread only.
+        inline static const EnumMask<MouseButton>& mouseButtonsHeld()
+        {
+            return Input::heldMouseButtons;
         }
+        /// @brief Retrieve every mouse button that went down this frame. A button clicked within a single frame is both pressed and released.
+        /// @note Main thread only.
+        inline static const EnumMask<MouseButton>& mouseButtonsPressedThisFrame()
+        {
+            return Input::pressedMouseButtons;
+        }
+        /// @brief Retrieve every mouse button that went up this frame.
+        /// @note Main thread only.
+        inline static const EnumMask<MouseButton>& mouseButtonsReleasedThisFrame()
+        {
+            return Input::releasedMouseButtons;
+        }
+
         /// @brief Retrieve whether key is pressed this frame.
         /// @param key Key to check.
         /// @return Whether key is pressed.
         /// @note Main thread only.
         inline static bool keyHeld(Key key)
         {
-            return Input::heldKeyInputs[size_t(key)];
+            return Input::heldKeys.test(key);
+        }
+        /// @brief Retrieve whether key went down this frame. Repeats don't count.
+        /// @param key Key to check.
+        /// @return Whether key went down.
+        /// @note Main thread only.
+        inline static bool keyPressed(Key key)
+        {
+            return Input::pressedKeys.test(key);
+        }
+        /// @brief Retrieve whether key went up this frame.
+        /// @param key Key to check.
+        /// @return Whether key went up.
+        /// @note Main thread only.
+        inline static bool keyReleased(Key key)
+        {
+            return Input::releasedKeys.test(key);
+        }
+        /// @brief Retrieve every key pressed this frame.
+        /// @note Main thread only.
+        inline static const EnumMask<Key>& keysHeld()
+        {
+            return Input::heldKeys;
+        }
+        /// @brief Retrieve every key that went down this frame. A key tapped within a single frame is both pressed and released.
+        /// @note Main thread only.
+        inline static const EnumMask<Key>& keysPressedThisFrame()
+        {
+            return Input::pressedKeys;
+        }
+        /// @brief Retrieve every key that went up this frame.
+        /// @note Main thread only.
+        inline static const EnumMask<Key>& keysReleasedThisFrame()
+        {
+            return Input::releasedKeys;
+        }
+
+        /// @brief Retrieve the number of mouse motion, scroll and key repeat events dropped since startup because input arrived faster than frames could consume it.
+        /// @note Thread-safe.
+        inline static uint64_t droppedInputEvents()
+        {
+            return Input::droppedInputRecords.load(std::memory_order_relaxed);
         }
 
         static void beginQueryTextInput();
@@ -0,0 +1,192 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include <Core/Debug.h>
+
+using namespace Firework;
+
+std::atomic<uint64_t> Profiler::frameStarts[Config::ProfilerFrameHistory] {};
+std::atomic<uint64_t> Profiler::frameCount = 0;
+
+#if FIREWORK_PROFILER
+namespace
+{
+    struct ThreadBuffer
+    {
+        // Fields are atomics so a dump racing the owning thread is well-defined. Relaxed stores of these compile to plain stores.
+        struct Zone
+        {
+            std::atomic<const char*> name = nullptr;
+            std::atomic<uint64_t> begin = 0;
+            std::atomic<uint64_t> end = 0;
+        };
+
+        std::array<Zone, Config::ProfilerZonesPerThread> zones;
+        /// Number of zones ever recorded. Only the owning thread writes it.
+        std::atomic<uint64_t> head = 0;
+
+        size_t id;
+        std::string name;
+    };
+
+    struct RecordedZone
+    {
+        const char* name;
+        uint64_t begin;
+        uint64_t end;
+    };
+} // namespace
+
+static_assert((Config::ProfilerZonesPerThread & (Config::ProfilerZonesPerThread - 1)) == 0, "Config::ProfilerZonesPerThread must be a power of two.");
+
+// Buffers outlive their threads, so a dump can still see zones from threads that have exited.
+static std::mutex threadBuffersLock;
+static std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+static thread_local ThreadBuffer* currentThreadBuffer = nullptr;
+
+static ThreadBuffer& threadBuffer()
+{
+    if (!currentThreadBuffer) [[unlikely]]
+    {
+        std::lock_guard guard(threadBuffersLock);
+        currentThreadBuffer = threadBuffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+        currentThreadBuffer->id = threadBuffers.size();
+        currentThreadBuffer->name = "Thread " + std::to_string(currentThreadBuffer->id);
+    }
+    return *currentThreadBuffer;
+}
+
+static void writeJsonString(std::ostream& stream, std::string_view string)
+{
+    stream << '"';
+    for (char c : string)
+    {
+        if (c == '"' || c == '\\')
+            stream << '\\' << c;
+        else if (uint8_t(c) < 0x20)
+            stream << ' ';
+        else
+            stream << c;
+    }
+    stream << '"';
+}
+#endif
+
+void Profiler::recordZone(const char* name, uint64_t begin, uint64_t end)
+{
+#if FIREWORK_PROFILER
+    ThreadBuffer& buffer = threadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    ThreadBuffer::Zone& zone = buffer.zones[head & (Config::ProfilerZonesPerThread - 1)];
+
+    // Pairs with the acquire fence in `dumpChromeTrace`: a dump that reads any of this zone is guaranteed to then see a head that marks the slot as being overwritten.
+    std::atomic_thread_fence(std::memory_order_release);
+    zone.name.store(name, std::memory_order_relaxed);
+    zone.begin.store(begin, std::memory_order_relaxed);
+    zone.end.store(end, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+#else
+    (void)name;
+    (void)begin;
+    (void)end;
+#endif
+}
+void Profiler::beginFrame()
+{
+#if FIREWORK_PROFILER
+    uint64_t frame = Profiler::frameCount.load(std::memory_order_relaxed);
+    Profiler::frameStarts[frame % Config::ProfilerFrameHistory].store(Profiler::now(), std::memory_order_relaxed);
+    Profiler::frameCount.store(frame + 1, std::memory_order_release);
+#endif
+}
+
+void Profiler::setThreadName(std::string name)
+{
+#if FIREWORK_PROFILER
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard guard(threadBuffersLock);
+    buffer.name = std::move(name);
+#else
+    (void)name;
+#endif
+}
+
+bool Profiler::dumpChromeTrace(const std::filesystem::path& path, size_t frames)
+{
+#if FIREWORK_PROFILER
+    uint64_t frameCount = Profiler::frameCount.load(std::memory_order_acquire);
+    frames = std::min<uint64_t>({ frames, frameCount, Config::ProfilerFrameHistory });
+    uint64_t windowBegin = frames ? Profiler::frameStarts[(frameCount - frames) % Config::ProfilerFrameHistory].load(std::memory_order_relaxed) : 0;
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file) [[unlikely]]
+    {
+        Debug::logError("Failed to open \"", path.string(), "\" to write a profiler trace to.");
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Firework\"}}";
+
+    std::vector<RecordedZone> zones;
+    std::lock_guard guard(threadBuffersLock);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : threadBuffers)
+    {
+        file << ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+        writeJsonString(file, buffer->name);
+        file << "}}";
+
+        // Copy first, then discard whatever the owning thread may have lapped while we were copying.
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = head > Config::ProfilerZonesPerThread ? head - Config::ProfilerZonesPerThread : 0;
+        zones.clear();
+        for (uint64_t i = first; i < head; i++)
+        {
+            const ThreadBuffer::Zone& zone = buffer->zones[i & (Config::ProfilerZonesPerThread - 1)];
+            zones.emplace_back(RecordedZone { .name = zone.name.load(std::memory_order_relaxed),
+                                              .begin = zone.begin.load(std::memory_order_relaxed),
+                                              .end = zone.end.load(std::memory_order_relaxed) });
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t headAfter = buffer->head.load(std::memory_order_relaxed);
+        uint64_t firstValid = headAfter >= Config::ProfilerZonesPerThread ? headAfter - Config::ProfilerZonesPerThread + 1 : 0;
+
+        for (uint64_t i = std::max(first, firstValid); i < head; i++)
+        {
+            const RecordedZone& zone = zones[size_t(i - first)];
+            if (zone.end < windowBegin)
+                continue;
+
+            // Timestamps are in microseconds, relative to the first frame in the trace.
+            uint64_t begin = std::max(zone.begin, windowBegin);
+            file << ",{\"name\":";
+            writeJsonString(file, zone.name);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << double(begin - windowBegin) / 1000.0
+                 << ",\"dur\":" << double(zone.end - begin) / 1000.0 << '}';
+        }
+    }
+    file << "]}\n";
+
+    file.flush();
+    if (!file) [[unlikely]]
+    {
+        Debug::logError("Failed to write profiler trace to \"", path.string(), "\".");
+        return false;
+    }
+    return true;
+#else
+    (void)path;
+    (void)frames;
+    Debug::logWarn("Profiler traces are unavailable, the runtime was built without FIREWORK_PROFILER.");
+    return false;
+#endif
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Firework.Runtime.CoreLib.Exports.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include <Firework/Config.h>
+
+namespace Firework
+{
+    class ProfileZone;
+} // namespace Firework
+
+namespace Firework::Internal
+{
+    class CoreEngine;
+} // namespace Firework::Internal
+
+_push_nowarn_msvc(_clWarn_msvc_export_interface);
+namespace Firework
+{
+    /// @brief Static class recording where time goes on each thread, as nested zones that can be exported as a Chrome trace.
+    /// Zones are recorded into a lock-free ring buffer per thread, so recording never contends with other threads or with dumping.
+    /// @note Only records when built with `FIREWORK_PROFILER`. Otherwise `_fw_profile_zone` compiles to nothing.
+    class _fw_core_api Profiler final
+    {
+        static std::atomic<uint64_t> frameStarts[Config::ProfilerFrameHistory];
+        static std::atomic<uint64_t> frameCount;
+
+        /// @internal
+        /// @brief Internal API. Retrieve the current profiler time.
+        /// @return Nanoseconds on the steady clock.
+        inline static uint64_t now()
+        {
+            return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+        /// @internal
+        /// @brief Internal API. Record a finished zone on the calling thread.
+        /// @param name Name of the zone. Must outlive the profiler, e.g. a string literal.
+        /// @param begin Time the zone began at, from `Profiler::now`.
+        /// @param end Time the zone ended at, from `Profiler::now`.
+        /// @note Thread-safe. Lock-free, except the first time a thread records.
+        static void recordZone(const char* name, uint64_t begin, uint64_t end);
+        /// @internal
+        /// @brief Internal API. Mark the start of a frame, which `Profiler::dumpChromeTrace` counts frames by.
+        /// @note Main thread only.
+        static void beginFrame();
+    public:
+        Profiler() = delete;
+
+        /// @brief Name the calling thread in traces.
+        /// @param name Name of the thread.
+        /// @note Thread-safe.
+        static void setThreadName(std::string name);
+
+        /// @brief Write the zones recorded over the last few frames to a file, in Chrome's trace event format. Open it with `chrome://tracing` or Perfetto.
+        /// @param path File to write to. Overwritten if it exists.
+        /// @param frames Number of most recent frames to write, at most `Config::ProfilerFrameHistory`. Zones from before a thread's ring buffer wrapped are gone.
+        /// @return Whether the trace was written. Always false when built without `FIREWORK_PROFILER`.
+        /// @note Thread-safe.
+        static bool dumpChromeTrace(const std::filesystem::path& path, size_t frames = Config::ProfilerFrameHistory);
+
+        friend class Firework::ProfileZone;
+        friend class Firework::Internal::CoreEngine;
+    };
+
+    /// @internal
+    /// @brief Internal API. Records a zone spanning its lifetime. Use `_fw_profile_zone` instead, so zones compile out with the profiler.
+    class ProfileZone final
+    {
+        const char* name;
+        uint64_t begin;
+    public:
+        inline explicit ProfileZone(const char* name) : name(name), begin(Profiler::now())
+        { }
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone(ProfileZone&&) = delete;
+        inline ~ProfileZone()
+        {
+            Profiler::recordZone(this->name, this->begin, Profiler::now());
+        }
+
+        ProfileZone& operator=(const ProfileZone&) = delete;
+        ProfileZone& operator=(ProfileZone&&) = delete;
+    };
+} // namespace Firework
+_pop_nowarn_msvc();
+
+#define _fw_profile_zone_concat_impl(a, b) a##b
+#define _fw_profile_zone_concat(a, b) _fw_profile_zone_concat_impl(a, b)
+#if FIREWORK_PROFILER
+/// @brief Profile the rest of the enclosing scope as a zone named `name`, which must be a string literal.
+#define _fw_profile_zone(name) ::Firework::ProfileZone _fw_profile_zone_concat(_fwProfileZone, __LINE__)(name)
+#else
+#define _fw_profile_zone(name) ((void)0)
+#endif
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <robin_hood.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Core/Profiler.h>
+#include <Core/RenderJob.h>
+
+namespace Firework
+{
+    /// @internal
+    /// @brief Internal API. Linear, chunked arena of render commands for a single frame.
+    /// Callables are stored inline, one after the other, and are only destroyed when the buffer is reset. Chunks are kept across resets, so once a buffer has grown to fit
+    /// a frame, recording subsequent frames of similar size does not allocate.
+    /// @note Not thread-safe. Recorded by one thread, executed and reset by one thread, never concurrently.
+    class RenderCommandBuffer final
+    {
+        constexpr static size_t ChunkAlignment = 64;
+        constexpr static size_t DefaultChunkSize = 64 * 1024;
+
+        struct CommandHeader
+        {
+            void (*invoke)(void*);
+            /// @brief `nullptr` for trivially destructible (POD) commands, which are simply forgotten on reset.
+            void (*destroy)(void*);
+            uint32_t payloadOffset;
+            uint32_t nextOffset;
+            RenderJobKey key;
+            bool required;
+        };
+
+        struct ChunkDeleter
+        {
+            inline void operator()(std::byte* data) const
+            {
+                ::operator delete[](data, std::align_val_t(ChunkAlignment));
+            }
+        };
+        struct Chunk
+        {
+            std::unique_ptr<std::byte[], ChunkDeleter> data;
+            size_t capacity = 0;
+            size_t used = 0;
+        };
+
+        std::vector<Chunk> chunks;
+        size_t currentChunk = 0;
+        size_t commandCount = 0;
+        size_t keyedCommandCount = 0;
+
+        /// @brief The newest command recorded for each coalescing key.
+        using LatestByKey = robin_hood::unordered_flat_map<RenderJobKey, const void*, RenderJobKey::Hash>;
+        /// @brief Scratch space for `execute`.
+        LatestByKey latestByKey;
+
+        constexpr static size_t alignUp(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+        inline static Chunk allocateChunk(size_t capacity)
+        {
+            return Chunk { .data = std::unique_ptr<std::byte[], ChunkDeleter>(static_cast<std::byte*>(::operator new[](capacity, std::align_val_t(ChunkAlignment)))),
+                           .capacity = capacity };
+        }
+
+        /// @brief Reserves space for a header followed by a payload of the given size and alignment, returning the chunk and header offset.
+        inline std::pair<Chunk*, size_t> reserve(size_t payloadSize, size_t payloadAlignment, size_t& payloadOffset)
+        {
+            auto fits = [&](const Chunk& chunk, size_t& headerOffset) -> bool
+            {
+                headerOffset = RenderCommandBuffer::alignUp(chunk.used, alignof(CommandHeader));
+                payloadOffset = RenderCommandBuffer::alignUp(headerOffset + sizeof(CommandHeader), payloadAlignment);
+                return payloadOffset + payloadSize <= chunk.capacity;
+            };
+
+            size_t headerOffset;
+            if (this->chunks.empty())
+                this->chunks.emplace_back(RenderCommandBuffer::allocateChunk(DefaultChunkSize));
+            if (fits(this->chunks[this->currentChunk], headerOffset)) [[likely]]
+                return { &this->chunks[this->currentChunk], headerOffset };
+
+            // Move on to the next (empty) chunk, growing or creating it if this command doesn't fit in a default-sized one.
+            ++this->currentChunk;
+            size_t required = RenderCommandBuffer::alignUp(sizeof(CommandHeader), payloadAlignment) + payloadSize;
+            if (this->currentChunk == this->chunks.size())
+                this->chunks.emplace_back(RenderCommandBuffer::allocateChunk(std::max(DefaultChunkSize, required)));
+            else if (this->chunks[this->currentChunk].capacity < required)
+                this->chunks[this->currentChunk] = RenderCommandBuffer::allocateChunk(required);
+
+            (void)fits(this->chunks[this->currentChunk], headerOffset);
+            return { &this->chunks[this->currentChunk], headerOffset };
+        }
+
+        inline void collectLatestByKey(LatestByKey& latest)
+        {
+            if (this->keyedCommandCount == 0) [[likely]]
+                return;
+
+            this->forEachCommand([&](CommandHeader& header, std::byte*)
+            {
+                if (header.key)
+                    latest[header.key] = &header;
+            });
+        }
+        inline size_t executeWith(const LatestByKey& latest, bool requiredOnly)
+        {
+            if (latest.empty()) [[likely]]
+            {
+                this->forEachCommand([&](CommandHeader& header, std::byte* command)
+                {
+                    if (!requiredOnly || header.required)
+                    {
+                        _fw_profile_zone("Render Job");
+                        header.invoke(command);
+                    }
+                });
+                return 0;
+            }
+
+            size_t superseded = 0;
+            this->forEachCommand([&](CommandHeader& header, std::byte* command)
+            {
+                if (header.key && latest.find(header.key)->second != &header)
+                    ++superseded;
+                else if (!requiredOnly || header.required)
+                {
+                    _fw_profile_zone("Render Job");
+                    header.invoke(command);
+                }
+            });
+            return superseded;
+        }
+
+        template <typename Func>
+        inline void forEachCommand(Func&& func)
+        {
+            for (size_t i = 0; i < this->chunks.size() && i <= this->currentChunk; i++)
+            {
+                std::byte* base = this->chunks[i].data.get();
+                for (size_t offset = 0; offset < this->chunks[i].used;)
+                {
+                    CommandHeader* header = std::launder(reinterpret_cast<CommandHeader*>(base + offset));
+                    func(*header, base + offset + header->payloadOffset);
+                    offset = header->nextOffset;
+                }
+            }
+        }
+    public:
+        RenderCommandBuffer() = default;
+        RenderCommandBuffer(const RenderCommandBuffer&) = delete;
+        RenderCommandBuffer(RenderCommandBuffer&&) = delete;
+        inline ~RenderCommandBuffer()
+        {
+            this->reset();
+        }
+
+        RenderCommandBuffer& operator=(const RenderCommandBuffer&) = delete;
+        RenderCommandBuffer& operator=(RenderCommandBuffer&&) = delete;
+
+        /// @internal
+        /// @brief Internal API. Records a command into the buffer.
+        /// @tparam Func ```requires std::invocable<Func>```
+        /// @param func Command to record. Stored inline in the buffer, no type-erased heap allocation is made.
+        /// @param required Whether this command has to run if the runtime is behind.
+        /// @param key Coalescing key. Only the last command recorded with a given key runs.
+        template <std::invocable<> Func>
+        inline void record(Func&& func, bool required = true, RenderJobKey key = {})
+        {
+            using Command = std::remove_cvref_t<Func>;
+            static_assert(alignof(Command) <= ChunkAlignment, "Render command is over-aligned.");
+
+            size_t payloadOffset;
+            auto [chunk, headerOffset] = this->reserve(sizeof(Command), alignof(Command), payloadOffset);
+
+            std::byte* base = chunk->data.get();
+            new(base + payloadOffset) Command(std::forward<Func>(func));
+            new(base + headerOffset) CommandHeader {
+                .invoke = [](void* command) { (*static_cast<Command*>(command))(); },
+                .destroy = std::is_trivially_destructible_v<Command> ? nullptr : +[](void* command) { static_cast<Command*>(command)->~Command(); },
+                .payloadOffset = uint32_t(payloadOffset - headerOffset),
+                .nextOffset = uint32_t(payloadOffset + sizeof(Command)),
+                .key = key,
+                .required = required
+            };
+            chunk->used = payloadOffset + sizeof(Command);
+            ++this->commandCount;
+            if (key)
+                ++this->keyedCommandCount;
+        }
+
+        /// @internal
+        /// @brief Internal API. Runs every recorded command, in recording order, skipping commands superseded by a later one with the same key.
+        /// @param requiredOnly Whether to only run commands recorded as required, i.e. the runtime is behind.
+        /// @return Number of commands skipped because they were superseded.
+        inline size_t execute(bool requiredOnly = false)
+        {
+            this->latestByKey.clear();
+            this->collectLatestByKey(this->latestByKey);
+            return this->executeWith(this->latestByKey, requiredOnly);
+        }
+        /// @internal
+        /// @brief Internal API. Destroys every recorded command and rewinds the buffer, keeping its memory for the next frame.
+        inline void reset()
+        {
+            this->forEachCommand([](CommandHeader& header, std::byte* command)
+            {
+                if (header.destroy)
+                    header.destroy(command);
+            });
+            for (Chunk& chunk : this->chunks) chunk.used = 0;
+            this->currentChunk = 0;
+            this->commandCount = 0;
+            this->keyedCommandCount = 0;
+        }
+
+        /// @internal
+        /// @brief Internal API. Retrieve the number of recorded commands.
+        inline size_t size() const
+        {
+            return this->commandCount;
+        }
+        /// @internal
+        /// @brief Internal API. Retrieve whether no commands have been recorded.
+        inline bool empty() const
+        {
+            return this->commandCount == 0;
+        }
+
+        friend class RenderCommandList;
+    };
+
+    /// @internal
+    /// @brief Internal API. Ordered list of command buffers making up a single frame.
+    /// Each buffer can be recorded by a different thread, and the buffers are executed one after another in list order, so work split across threads in traversal order
+    /// runs in the same order it would have serially. Coalescing keys apply across the whole list. Buffers are kept across resets.
+    /// @note Not thread-safe. Distinct buffers may be recorded concurrently, after the list has been resized.
+    class RenderCommandList final
+    {
+        std::vector<std::unique_ptr<RenderCommandBuffer>> buffers;
+        size_t bufferCount = 0;
+        RenderCommandBuffer::LatestByKey latestByKey;
+    public:
+        RenderCommandList() = default;
+        RenderCommandList(const RenderCommandList&) = delete;
+        RenderCommandList(RenderCommandList&&) = delete;
+
+        RenderCommandList& operator=(const RenderCommandList&) = delete;
+        RenderCommandList& operator=(RenderCommandList&&) = delete;
+
+        /// @internal
+        /// @brief Internal API. Set the number of buffers in the list.
+        /// @param count Number of buffers. Any buffers past `count` must be empty.
+        inline void resize(size_t count)
+        {
+            while (this->buffers.size() < count) this->buffers.emplace_back(std::make_unique<RenderCommandBuffer>());
+            this->bufferCount = count;
+        }
+        /// @internal
+        /// @brief Internal API. Retrieve a buffer to record into.
+        /// @param index Index of the buffer, less than the size the list was last resized to.
+        inline RenderCommandBuffer& operator[](size_t index)
+        {
+            return *this->buffers[index];
+        }
+
+        /// @internal
+        /// @brief Internal API. Runs every recorded command, buffer by buffer, skipping commands superseded by a later one with the same key anywhere in the list.
+        /// @param requiredOnly Whether to only run commands recorded as required, i.e. the runtime is behind.
+        /// @return Number of commands skipped because they were superseded.
+        inline size_t execute(bool requiredOnly = false)
+        {
+            this->latestByKey.clear();
+            for (size_t i = 0; i < this->bufferCount; i++) this->buffers[i]->collectLatestByKey(this->latestByKey);
+
+            size_t superseded = 0;
+            for (size_t i = 0; i < this->bufferCount; i++) superseded += this->buffers[i]->executeWith(this->latestByKey, requiredOnly);
+            return superseded;
+        }
+        /// @internal
+        /// @brief Internal API. Destroys every recorded command and empties the list, keeping its buffers and their memory for the next frame.
+        inline void reset()
+        {
+            for (size_t i = 0; i < this->bufferCount; i++) this->buffers[i]->reset();
+            this->bufferCount = 0;
+        }
+
+        /// @internal
+        /// @brief Internal API. Retrieve the number of recorded commands across every buffer.
+        inline size_t size() const
+        {
+            size_t ret = 0;
+            for (size_t i = 0; i < this->bufferCount; i++) ret += this->buffers[i]->size();
+            return ret;
+        }
+    };
+} // namespace Firework
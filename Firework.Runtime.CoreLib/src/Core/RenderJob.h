@@ -1,7 +1,9 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
 #include <function.h>
+#include <functional>
 #include <type_traits>
 #include <utility>
 
@@ -9,6 +11,33 @@
 
 namespace Firework
 {
+    class RenderCommandList;
+
+    /// @internal
+    /// @brief Internal API. Identifies what a render job does, so a newer job with the same key supersedes an older one that hasn't run yet.
+    /// A default-constructed key never coalesces.
+    struct RenderJobKey
+    {
+        /// @brief Object the job belongs to, usually a component.
+        const void* owner = nullptr;
+        /// @brief What the job does for its owner, any value unique among the owner's jobs.
+        uint32_t purpose = 0;
+
+        explicit operator bool() const
+        {
+            return this->owner;
+        }
+        friend bool operator==(const RenderJobKey&, const RenderJobKey&) = default;
+
+        struct Hash
+        {
+            inline size_t operator()(const RenderJobKey& key) const
+            {
+                return std::hash<const void*>()(key.owner) ^ (size_t(key.purpose) * size_t(0x9E3779B97F4A7C15ull));
+            }
+        };
+    };
+
     /// @internal
     /// @brief Internal API. Functor wrapper for a funtion of signature void(), used to submit render jobs.
     /// @note Always pass by value.
@@ -20,28 +49,52 @@ namespace Firework
         /// @tparam Func ```requires requires { func::function<void()>(func); }```
         /// @param func Function to create job from.
         /// @param required Whether this job has to run if the runtime is behind.
+        /// @param key Coalescing key. If a newer job with the same key is queued before this one runs, this one is skipped.
         /// @return Render job that will call the given function.
         template <std::invocable<> Func>
         requires (!std::same_as<RenderJob, std::remove_cvref_t<Func>>) // msvc will pass a `RenderJob` as `func`.
-        RenderJob(Func&& func, bool required = true) : func(func), _required(required)
+        RenderJob(Func&& func, bool required = true, RenderJobKey key = {}) : func(func), _key(key), _required(required)
         { }
         RenderJob(const RenderJob&) = default;
-        RenderJob(RenderJob&& other)
+        RenderJob(RenderJob&& other) noexcept
         {
             swap(*this, other);
         }
 
         RenderJob& operator=(const RenderJob&) = default;
-        RenderJob& operator=(RenderJob&& other)
+        RenderJob& operator=(RenderJob&& other) noexcept
         {
             swap(*this, other);
             return *this;
         }
 
+        /// @internal
+        /// @brief Internal API. Creates a frame marker, which submits a recorded frame to the render thread as one unit.
+        /// @param commandList Command list the frame was recorded into.
+        /// @return Render job marking the end of a frame.
+        inline static RenderJob frame(RenderCommandList& commandList)
+        {
+            RenderJob ret;
+            ret._frame = &commandList;
+            ret._required = true;
+            return ret;
+        }
+
         bool required() const
         {
             return this->_required;
         }
+        const RenderJobKey& key() const
+        {
+            return this->_key;
+        }
+        /// @internal
+        /// @brief Internal API. Retrieve the command list of the frame this job marks.
+        /// @return The frame's command list, or `nullptr` if this is an ordinary job.
+        RenderCommandList* frame() const
+        {
+            return this->_frame;
+        }
 
         const func::function<void()>& function() const
         {
@@ -54,16 +107,20 @@ namespace Firework
             this->func();
         }
 
-        friend void swap(RenderJob& a, RenderJob& b)
+        friend void swap(RenderJob& a, RenderJob& b) noexcept
         {
             using func::swap;
             using std::swap;
 
             swap(a.func, b.func);
+            swap(a._key, b._key);
+            swap(a._frame, b._frame);
             swap(a._required, b._required);
         }
     private:
         func::function<void()> func;
+        RenderJobKey _key;
+        RenderCommandList* _frame = nullptr;
         bool _required = false;
     };
 } // namespace Firework
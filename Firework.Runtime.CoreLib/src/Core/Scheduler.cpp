@@ -0,0 +1,366 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <concurrentqueue.h>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Core/Debug.h>
+#include <Core/Profiler.h>
+#include <Firework/Config.h>
+#include <Library/WorkStealingDeque.h>
+
+using namespace Firework;
+using namespace Firework::Internal;
+
+namespace Firework::Internal
+{
+    struct Task
+    {
+        func::function<void()> func;
+        /// @brief Unfinished dependencies, plus one held by whoever is submitting the task.
+        std::atomic<uint32_t> pendingDependencies = 1;
+        /// @brief Set by whichever thread runs the task, either one that took it from a queue, or one waiting on it.
+        std::atomic<bool> claimed = false;
+        std::atomic<bool> finished = false;
+        std::atomic<bool> waited = false;
+
+        std::mutex continuationLock;
+        std::vector<std::shared_ptr<Task>> continuations;
+        /// @brief Dependencies unfinished at submission, so a thread waiting on the task can run them itself. Never modified after submission.
+        std::vector<std::weak_ptr<Task>> dependencies;
+
+        /// @brief Keeps the task alive while it's sitting in a queue.
+        std::shared_ptr<Task> self;
+    };
+} // namespace Firework::Internal
+
+struct Worker
+{
+    WorkStealingDeque<Task*> deque;
+    std::thread thread;
+};
+
+static std::vector<std::unique_ptr<Worker>> workers;
+static moodycamel::ConcurrentQueue<Task*> injectionQueue;
+/// Helpers of `parallelFor`, taken ahead of the injection queue so a loop isn't left running serially behind queued background jobs.
+static moodycamel::ConcurrentQueue<Task*> priorityQueue;
+static thread_local Worker* currentWorker = nullptr;
+
+/// Incremented whenever there may be new work, or a waited-on task finishes. Sleeping workers wait on this, so a notification can't be lost between checking for work and
+/// going to sleep.
+static std::atomic<uint32_t> workEpoch = 0;
+static std::atomic<uint32_t> sleepingThreads = 0;
+/// Incremented whenever a waited-on task or a `parallelFor` finishes. Threads other than workers wait on this instead, so they aren't woken, in place of a worker,
+/// for work they won't take.
+static std::atomic<uint32_t> doneEpoch = 0;
+static std::atomic<uint32_t> waitingThreads = 0;
+static std::atomic<bool> stopping = false;
+
+static void notifyWork()
+{
+    workEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepingThreads.load(std::memory_order_seq_cst) > 0)
+        workEpoch.notify_one();
+}
+static void notifyAll()
+{
+    workEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepingThreads.load(std::memory_order_seq_cst) > 0)
+        workEpoch.notify_all();
+    doneEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (waitingThreads.load(std::memory_order_seq_cst) > 0)
+        doneEpoch.notify_all();
+}
+
+static void schedule(std::shared_ptr<Task>&& task, bool priority = false)
+{
+    Task* rawTask = task.get();
+    rawTask->self = std::move(task);
+
+    if (priority)
+        priorityQueue.enqueue(rawTask);
+    else if (currentWorker)
+        currentWorker->deque.push(rawTask);
+    else
+        injectionQueue.enqueue(rawTask);
+    notifyWork();
+}
+
+/// Runs a task claimed by the calling thread.
+static void runTask(Task* task)
+{
+    try
+    {
+        task->func();
+    }
+    catch (const std::exception& ex)
+    {
+        Debug::logError("Unhandled exception thrown in worker task: ", ex.what());
+    }
+    catch (...)
+    {
+        Debug::logError("Unhandled exception thrown in worker task.");
+    }
+    task->func = nullptr;
+
+    std::vector<std::shared_ptr<Task>> continuations;
+    {
+        std::lock_guard guard(task->continuationLock);
+        task->finished.store(true, std::memory_order_seq_cst);
+        continuations.swap(task->continuations);
+    }
+    for (std::shared_ptr<Task>& continuation : continuations)
+    {
+        if (continuation->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            schedule(std::move(continuation));
+    }
+
+    if (task->waited.load(std::memory_order_seq_cst))
+        notifyAll();
+}
+/// Runs a task taken from a queue, unless a thread waiting on it has run it already.
+static void runQueued(Task* task)
+{
+    std::shared_ptr<Task> keepAlive = std::move(task->self);
+    if (!task->claimed.exchange(true, std::memory_order_acq_rel))
+        runTask(task);
+}
+
+static bool tryRunOne()
+{
+    Task* task = nullptr;
+    if (currentWorker && currentWorker->deque.pop(task))
+    {
+        runQueued(task);
+        return true;
+    }
+    if (priorityQueue.try_dequeue(task) || injectionQueue.try_dequeue(task))
+    {
+        runQueued(task);
+        return true;
+    }
+
+    static thread_local size_t stealFrom = 0;
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        Worker* victim = workers[stealFrom++ % workers.size()].get();
+        if (victim != currentWorker && victim->deque.steal(task))
+        {
+            runQueued(task);
+            return true;
+        }
+    }
+    return false;
+}
+/// Runs `task`, or one of the dependencies holding it back, if one is ready and no other thread has taken it.
+static bool tryRunChain(const std::shared_ptr<Task>& task)
+{
+    if (task->finished.load(std::memory_order_acquire))
+        return false;
+    if (task->pendingDependencies.load(std::memory_order_acquire) == 0)
+    {
+        if (task->claimed.exchange(true, std::memory_order_acq_rel))
+            return false;
+        runTask(task.get());
+        return true;
+    }
+
+    for (const std::weak_ptr<Task>& dependency : task->dependencies)
+    {
+        if (std::shared_ptr<Task> lockedDependency = dependency.lock(); lockedDependency && tryRunChain(lockedDependency))
+            return true;
+    }
+    return false;
+}
+
+/// Runs pending tasks until `condition` holds, sleeping while there's nothing to do. Workers run anything. Any other thread only runs what `help` offers it, which is
+/// its own work, so a main thread waiting mid-frame doesn't pick up an unrelated background job, unless there are no workers to run it instead.
+template <typename Condition, typename Help>
+static void helpUntil(Condition&& condition, Help&& help)
+{
+    bool runAnything = currentWorker || workers.empty();
+    std::atomic<uint32_t>& epoch = runAnything ? workEpoch : doneEpoch;
+    std::atomic<uint32_t>& sleeping = runAnything ? sleepingThreads : waitingThreads;
+    auto tryHelp = [&] { return help() || (runAnything && tryRunOne()); };
+
+    while (!condition())
+    {
+        if (tryHelp())
+            continue;
+
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t seen = epoch.load(std::memory_order_seq_cst);
+        if (!condition() && !tryHelp())
+            epoch.wait(seen, std::memory_order_seq_cst);
+        sleeping.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+bool TaskHandle::done() const
+{
+    return !this->task || this->task->finished.load(std::memory_order_acquire);
+}
+void TaskHandle::wait() const
+{
+    if (!this->task)
+        return;
+
+    this->task->waited.store(true, std::memory_order_seq_cst);
+    helpUntil([this] { return this->task->finished.load(std::memory_order_seq_cst); }, [this] { return tryRunChain(this->task); });
+}
+
+TaskHandle Scheduler::submitImpl(func::function<void()>&& func, std::span<const TaskHandle> dependencies)
+{
+    std::shared_ptr<Task> task = std::make_shared<Task>();
+    task->func = std::move(func);
+    task->pendingDependencies.store(uint32_t(1 + dependencies.size()), std::memory_order_relaxed);
+
+    for (const TaskHandle& dependency : dependencies)
+    {
+        if (dependency.task)
+        {
+            std::lock_guard guard(dependency.task->continuationLock);
+            if (!dependency.task->finished.load(std::memory_order_relaxed))
+            {
+                dependency.task->continuations.emplace_back(task);
+                task->dependencies.emplace_back(dependency.task);
+                continue;
+            }
+        }
+        task->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    TaskHandle ret(task);
+    if (task->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        schedule(std::move(task));
+    return ret;
+}
+
+void Scheduler::parallelForImpl(size_t begin, size_t end, size_t grain, func::function<void(size_t, size_t)>&& body)
+{
+    _fence_value_return(void(), end <= begin);
+
+    grain = std::max(grain, size_t(1));
+    size_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks == 1 || workers.empty())
+    {
+        body(begin, end);
+        return;
+    }
+
+    struct ParallelForState
+    {
+        func::function<void(size_t, size_t)> body;
+        size_t begin, end, grain, chunks;
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> finished = 0;
+
+        std::mutex exceptionLock;
+        std::exception_ptr exception;
+
+        void work()
+        {
+            for (size_t chunk; (chunk = this->next.fetch_add(1, std::memory_order_relaxed)) < this->chunks;)
+            {
+                try
+                {
+                    size_t chunkBegin = this->begin + chunk * this->grain;
+                    this->body(chunkBegin, std::min(chunkBegin + this->grain, this->end));
+                }
+                catch (...)
+                {
+                    std::lock_guard guard(this->exceptionLock);
+                    if (!this->exception)
+                        this->exception = std::current_exception();
+                }
+
+                if (this->finished.fetch_add(1, std::memory_order_seq_cst) + 1 == this->chunks)
+                    notifyAll();
+            }
+        }
+    };
+
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    state->body = std::move(body);
+    state->begin = begin;
+    state->end = end;
+    state->grain = grain;
+    state->chunks = chunks;
+
+    // Helpers that start after every chunk has been claimed simply exit.
+    size_t helpers = std::min(workers.size(), chunks - 1);
+    for (size_t i = 0; i < helpers; i++)
+    {
+        std::shared_ptr<Task> task = std::make_shared<Task>();
+        task->func = [state] { state->work(); };
+        schedule(std::move(task), true);
+    }
+
+    // Every chunk has been claimed once this returns, what's left is waiting for the ones still running elsewhere.
+    state->work();
+    helpUntil([&state] { return state->finished.load(std::memory_order_seq_cst) == state->chunks; }, [] { return false; });
+
+    if (state->exception)
+        std::rethrow_exception(state->exception);
+}
+
+size_t Scheduler::workerCount()
+{
+    return workers.size();
+}
+
+void Scheduler::startup()
+{
+    size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t count = hardwareThreads > Config::ReservedEngineThreads ? hardwareThreads - Config::ReservedEngineThreads : 1;
+
+    stopping.store(false, std::memory_order_seq_cst);
+    for (size_t i = 0; i < count; i++) workers.emplace_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->thread = std::thread([worker = workers[i].get(), i]
+        {
+            Profiler::setThreadName("Worker " + std::to_string(i));
+            currentWorker = worker;
+            helpUntil([] { return stopping.load(std::memory_order_seq_cst); }, [] { return false; });
+            currentWorker = nullptr;
+        });
+    }
+    notifyAll(); // For anything submitted before startup.
+}
+void Scheduler::shutdown()
+{
+    stopping.store(true, std::memory_order_seq_cst);
+    workEpoch.fetch_add(1, std::memory_order_seq_cst);
+    workEpoch.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers) worker->thread.join();
+
+    // Workers stop after their current task, run whatever they left behind here. Anything those tasks submit lands in the injection queue.
+    bool ranAny;
+    do
+    {
+        ranAny = false;
+        Task* task;
+        while (priorityQueue.try_dequeue(task) || injectionQueue.try_dequeue(task))
+        {
+            runQueued(task);
+            ranAny = true;
+        }
+        for (std::unique_ptr<Worker>& worker : workers)
+        {
+            while (worker->deque.steal(task))
+            {
+                runQueued(task);
+                ranAny = true;
+            }
+        }
+    }
+    while (ranAny);
+
+    workers.clear();
+}
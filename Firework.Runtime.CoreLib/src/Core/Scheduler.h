@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Firework.Runtime.CoreLib.Exports.h"
+
+#include <concepts>
+#include <cstddef>
+#include <function.h>
+#include <memory>
+#include <span>
+#include <utility>
+
+namespace Firework::Internal
+{
+    class CoreEngine;
+    struct Task;
+} // namespace Firework::Internal
+
+_push_nowarn_msvc(_clWarn_msvc_export_interface);
+namespace Firework
+{
+    class Scheduler;
+
+    /// @brief Handle to a task submitted to the `Firework::Scheduler`.
+    /// @note Copies refer to the same task.
+    class _fw_core_api TaskHandle final
+    {
+        std::shared_ptr<Internal::Task> task;
+
+        inline explicit TaskHandle(std::shared_ptr<Internal::Task> task) : task(std::move(task))
+        { }
+    public:
+        TaskHandle() = default;
+
+        /// @brief Retrieve whether the task has finished running.
+        /// @return Whether the task has finished running. An empty handle is always done.
+        /// @note Thread-safe.
+        bool done() const;
+        /// @brief Block until the task has finished running. A worker thread runs other pending tasks in the meantime, any other thread only runs this task or its
+        /// dependencies, if they're ready and not yet taken.
+        /// @note Thread-safe.
+        void wait() const;
+
+        /// @brief Submit a continuation, run once this task has finished.
+        /// @tparam Func ```requires std::invocable<Func>```
+        /// @param func Continuation to run.
+        /// @return Handle to the continuation.
+        /// @note Thread-safe.
+        template <std::invocable<> Func>
+        inline TaskHandle then(Func&& func) const;
+
+        inline explicit operator bool() const
+        {
+            return bool(this->task);
+        }
+
+        friend class Firework::Scheduler;
+    };
+
+    /// @brief Static class containing functionality relevant to running work on the background worker threads.
+    /// Each worker owns a work-stealing deque. Tasks submitted from a worker go onto its own deque, tasks submitted from any other thread go onto a shared injection
+    /// queue. Idle workers steal from each other before sleeping. Helpers of `parallelFor` go onto a priority queue, taken ahead of the injection queue.
+    class _fw_core_api Scheduler final
+    {
+        static TaskHandle submitImpl(func::function<void()>&& func, std::span<const TaskHandle> dependencies);
+        static void parallelForImpl(size_t begin, size_t end, size_t grain, func::function<void(size_t, size_t)>&& body);
+
+        /// @internal
+        /// @brief Internal API. Start the worker threads. Tasks submitted beforehand are run once started.
+        /// @note Main thread only.
+        static void startup();
+        /// @internal
+        /// @brief Internal API. Run every pending task, then stop and join the worker threads.
+        /// @note Main thread only.
+        static void shutdown();
+    public:
+        Scheduler() = delete;
+
+        /// @brief Submit a task to be run on a worker thread.
+        /// @tparam Func ```requires std::invocable<Func>```
+        /// @param func Task to run.
+        /// @return Handle to the task.
+        /// @note Thread-safe.
+        template <std::invocable<> Func>
+        inline static TaskHandle submit(Func&& func)
+        {
+            return Scheduler::submitImpl(func::function<void()>(std::forward<Func>(func)), {});
+        }
+        /// @brief Submit a task to be run on a worker thread once all of its dependencies have finished.
+        /// @tparam Func ```requires std::invocable<Func>```
+        /// @param dependencies Tasks that must finish first. Empty handles are ignored.
+        /// @param func Task to run.
+        /// @return Handle to the task.
+        /// @note Thread-safe.
+        template <std::invocable<> Func>
+        inline static TaskHandle submitAfter(std::span<const TaskHandle> dependencies, Func&& func)
+        {
+            return Scheduler::submitImpl(func::function<void()>(std::forward<Func>(func)), dependencies);
+        }
+
+        /// @brief Run `body` over [begin, end) split into chunks of `grain` indices, across the worker threads and the calling thread. Blocks until every chunk has run.
+        /// @tparam Func ```requires std::invocable<Func, size_t, size_t>```
+        /// @param begin First index.
+        /// @param end One past the last index.
+        /// @param grain Number of indices per chunk.
+        /// @param body Called with the [begin, end) of each chunk. Chunks may run concurrently and in any order.
+        /// @throws Rethrows the first exception thrown by `body`, once every chunk has finished.
+        /// @note Thread-safe. May be nested.
+        template <std::invocable<size_t, size_t> Func>
+        inline static void parallelFor(size_t begin, size_t end, size_t grain, Func&& body)
+        {
+            Scheduler::parallelForImpl(begin, end, grain, func::function<void(size_t, size_t)>(std::forward<Func>(body)));
+        }
+
+        /// @brief Retrieve the number of worker threads.
+        /// @note Thread-safe.
+        static size_t workerCount();
+
+        friend class Firework::TaskHandle;
+        friend class Firework::Internal::CoreEngine;
+    };
+
+    template <std::invocable<> Func>
+    inline TaskHandle TaskHandle::then(Func&& func) const
+    {
+        return Scheduler::submitAfter(std::span<const TaskHandle>(this, 1), std::forward<Func>(func));
+    }
+} // namespace Firework
+_pop_nowarn_msvc();
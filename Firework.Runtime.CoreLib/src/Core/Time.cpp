@@ -1,6 +1,69 @@
 #include "Time.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace Firework;
 
 float Time::frameDeltaTime = 0.0f;
 float Time::timeScale = 1.0f;
+
+std::array<float, Config::FrameStatisticsWindow> Time::frameTimes {};
+uint64_t Time::frameCount = 0;
+uint64_t Time::missedDeadlineCount = 0;
+
+std::atomic<int64_t> Time::threadStartNanoseconds[size_t(EngineThread::Count)] {};
+std::atomic<uint64_t> Time::threadIdleNanoseconds[size_t(EngineThread::Count)] {};
+
+static int64_t steadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Time::recordFrame(float frameTime, bool missedDeadline)
+{
+    Time::frameTimes[Time::frameCount % Time::frameTimes.size()] = frameTime;
+    ++Time::frameCount;
+    if (missedDeadline)
+        ++Time::missedDeadlineCount;
+}
+void Time::recordThreadStart(EngineThread thread)
+{
+    Time::threadIdleNanoseconds[size_t(thread)].store(0, std::memory_order_relaxed);
+    Time::threadStartNanoseconds[size_t(thread)].store(steadyNanoseconds(), std::memory_order_release);
+}
+
+FrameStatistics Time::frameStatistics()
+{
+    FrameStatistics ret { .frameCount = Time::frameCount, .missedDeadlines = Time::missedDeadlineCount };
+
+    std::vector<float> sorted(Time::frameTimes.begin(), Time::frameTimes.begin() + std::min<uint64_t>(Time::frameCount, Time::frameTimes.size()));
+    if (sorted.empty())
+        return ret;
+    std::sort(sorted.begin(), sorted.end());
+
+    auto percentile = [&](float p) { return sorted[std::min(size_t(p * float(sorted.size() - 1) + 0.5f), sorted.size() - 1)]; };
+    ret.p50 = percentile(0.50f);
+    ret.p95 = percentile(0.95f);
+    ret.p99 = percentile(0.99f);
+    return ret;
+}
+std::chrono::nanoseconds Time::threadBusyTime(EngineThread thread)
+{
+    int64_t start = Time::threadStartNanoseconds[size_t(thread)].load(std::memory_order_acquire);
+    if (!start)
+        return std::chrono::nanoseconds(0);
+
+    int64_t running = steadyNanoseconds() - start;
+    int64_t idle = int64_t(Time::threadIdleNanoseconds[size_t(thread)].load(std::memory_order_relaxed));
+    return std::chrono::nanoseconds(std::max(running - idle, int64_t(0)));
+}
+float Time::threadBusyFraction(EngineThread thread)
+{
+    int64_t start = Time::threadStartNanoseconds[size_t(thread)].load(std::memory_order_acquire);
+    if (!start)
+        return 0.0f;
+
+    int64_t running = steadyNanoseconds() - start;
+    return running > 0 ? std::clamp(float(Time::threadBusyTime(thread).count()) / float(running), 0.0f, 1.0f) : 0.0f;
+}
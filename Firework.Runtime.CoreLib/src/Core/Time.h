@@ -2,16 +2,71 @@
 
 #include "Firework.Runtime.CoreLib.Exports.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <Firework/Config.h>
+
 namespace Firework::Internal
 {
     class CoreEngine;
 }
 
+_push_nowarn_msvc(_clWarn_msvc_export_interface);
 namespace Firework
 {
+    /// @brief Threads run by the engine.
+    enum class EngineThread : uint_fast8_t
+    {
+        Main,
+        Render,
+        Window,
+        Count
+    };
+
+    /// @brief Frame time statistics over the last `Config::FrameStatisticsWindow` frames.
+    struct FrameStatistics
+    {
+        /// @brief Median frame time in seconds.
+        float p50 = 0.0f;
+        /// @brief 95th percentile frame time in seconds.
+        float p95 = 0.0f;
+        /// @brief 99th percentile frame time in seconds.
+        float p99 = 0.0f;
+        /// @brief Number of frames run since startup.
+        uint64_t frameCount = 0;
+        /// @brief Number of frames since startup that started more than half a frame period late.
+        uint64_t missedDeadlines = 0;
+    };
+
     class _fw_core_api Time final
     {
         static float frameDeltaTime;
+
+        static std::array<float, Config::FrameStatisticsWindow> frameTimes;
+        static uint64_t frameCount;
+        static uint64_t missedDeadlineCount;
+
+        static std::atomic<int64_t> threadStartNanoseconds[size_t(EngineThread::Count)];
+        static std::atomic<uint64_t> threadIdleNanoseconds[size_t(EngineThread::Count)];
+
+        /// @internal
+        /// @brief Internal API. Record the time a frame took.
+        /// @note Main thread only.
+        static void recordFrame(float frameTime, bool missedDeadline);
+        /// @internal
+        /// @brief Internal API. Record that an engine thread has started running.
+        /// @note Thread-safe.
+        static void recordThreadStart(EngineThread thread);
+        /// @internal
+        /// @brief Internal API. Record time an engine thread spent waiting for work.
+        /// @note Thread-safe.
+        inline static void recordThreadIdle(EngineThread thread, std::chrono::nanoseconds idle)
+        {
+            Time::threadIdleNanoseconds[size_t(thread)].fetch_add(uint64_t(idle.count()), std::memory_order_relaxed);
+        }
     public:
         static float timeScale;
 
@@ -24,6 +79,22 @@ namespace Firework
             return Time::frameDeltaTime;
         }
 
+        /// @brief Retrieve rolling frame time statistics.
+        /// @return Frame time percentiles over the last `Config::FrameStatisticsWindow` frames, and frame and missed deadline counts since startup.
+        /// @note Main thread only.
+        static FrameStatistics frameStatistics();
+        /// @brief Retrieve how long an engine thread has spent doing work, rather than waiting for it, since it started.
+        /// @param thread Engine thread to query.
+        /// @return Busy time of the thread, zero if it hasn't started.
+        /// @note Thread-safe.
+        static std::chrono::nanoseconds threadBusyTime(EngineThread thread);
+        /// @brief Retrieve the fraction of time an engine thread has spent doing work, rather than waiting for it, since it started.
+        /// @param thread Engine thread to query.
+        /// @return Busy time of the thread over its running time, from 0 to 1.
+        /// @note Thread-safe.
+        static float threadBusyFraction(EngineThread thread);
+
         friend class Firework::Internal::CoreEngine;
     };
 } // namespace Firework
+_pop_nowarn_msvc();
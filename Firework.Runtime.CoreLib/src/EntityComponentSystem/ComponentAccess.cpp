@@ -0,0 +1,58 @@
+#include "ComponentAccess.h"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <Core/Debug.h>
+
+using namespace Firework;
+using namespace Firework::Internal;
+
+#if FIREWORK_ECS_ACCESS_CHECKS
+namespace
+{
+    struct ComponentUsage
+    {
+        uint32_t readers = 0;
+        uint32_t writers = 0;
+    };
+} // namespace
+
+static std::mutex componentUsageLock;
+// Indexed by `ComponentID`.
+static std::vector<ComponentUsage> componentUsage;
+#endif
+
+void ComponentAccessChecker::acquire(std::span<const ComponentID> ids, std::span<const bool> writes)
+{
+#if FIREWORK_ECS_ACCESS_CHECKS
+    std::lock_guard guard(componentUsageLock);
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (ids[i] >= componentUsage.size())
+            componentUsage.resize(size_t(ids[i]) + 1);
+
+        ComponentUsage& usage = componentUsage[ids[i]];
+        if (writes[i] ? usage.readers || usage.writers : usage.writers) [[unlikely]]
+        {
+            Debug::logError("Parallel job ", writes[i] ? "writing" : "reading", " component type `", ComponentRegistry::typeOf(ids[i]).name(),
+                            "` conflicts with another job ", usage.writers ? "writing" : "reading", " it concurrently.");
+        }
+        ++(writes[i] ? usage.writers : usage.readers);
+    }
+#else
+    (void)ids;
+    (void)writes;
+#endif
+}
+void ComponentAccessChecker::release(std::span<const ComponentID> ids, std::span<const bool> writes)
+{
+#if FIREWORK_ECS_ACCESS_CHECKS
+    std::lock_guard guard(componentUsageLock);
+    for (size_t i = 0; i < ids.size(); i++) --(writes[i] ? componentUsage[ids[i]].writers : componentUsage[ids[i]].readers);
+#else
+    (void)ids;
+    (void)writes;
+#endif
+}
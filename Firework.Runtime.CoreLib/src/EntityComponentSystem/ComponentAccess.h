@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Firework.Runtime.CoreLib.Exports.h"
+
+#include <span>
+#include <type_traits>
+
+#include <EntityComponentSystem/ComponentID.h>
+#include <Firework/Config.h>
+
+namespace Firework
+{
+    /// @brief Access specifier declaring a component type is only read.
+    /// @tparam T Component type.
+    template <typename T>
+    struct Read
+    { };
+    /// @brief Access specifier declaring a component type is read and written.
+    /// @tparam T Component type.
+    template <typename T>
+    struct Write
+    { };
+} // namespace Firework
+
+namespace Firework::Internal
+{
+    /// @internal
+    /// @brief Internal API. Component type and reference type of an access specifier.
+    template <typename>
+    struct ComponentAccessTraits;
+    template <typename T>
+    struct ComponentAccessTraits<Read<T>>
+    {
+        using Type = T;
+        using Reference = const T&;
+        constexpr static bool Writes = false;
+    };
+    template <typename T>
+    struct ComponentAccessTraits<Write<T>>
+    {
+        using Type = T;
+        using Reference = T&;
+        constexpr static bool Writes = true;
+    };
+
+    /// @internal
+    /// @brief Internal API. Whether a type is a component access specifier, `Read<T>` or `Write<T>`.
+    template <typename T>
+    concept ComponentAccessSpecifier = requires { typename ComponentAccessTraits<T>::Type; };
+
+    /// @internal
+    /// @brief Internal API. Whether access specifiers each name a different component type.
+    template <typename...>
+    constexpr bool DistinctComponentAccess = true;
+    template <typename A, typename... Rest>
+    constexpr bool DistinctComponentAccess<A, Rest...> =
+        (!std::is_same_v<std::remove_cvref_t<typename ComponentAccessTraits<A>::Type>, std::remove_cvref_t<typename ComponentAccessTraits<Rest>::Type>> && ...) &&
+        DistinctComponentAccess<Rest...>;
+
+    /// @internal
+    /// @brief Internal API. Static class tracking the component types in use by running parallel jobs, to flag jobs that conflict.
+    /// Two jobs conflict if one writes a component type the other reads or writes.
+    /// @note Only does anything with `FIREWORK_ECS_ACCESS_CHECKS`, on by default in debug builds.
+    class _fw_core_api ComponentAccessChecker final
+    {
+    public:
+        ComponentAccessChecker() = delete;
+
+        /// @internal
+        /// @brief Internal API. Mark component types as in use by a job, logging an error for each one that conflicts with a job already running.
+        /// @param ids Component types accessed.
+        /// @param writes Whether each type is written, parallel to `ids`.
+        /// @note Thread-safe.
+        static void acquire(std::span<const ComponentID> ids, std::span<const bool> writes);
+        /// @internal
+        /// @brief Internal API. Mark component types as no longer in use by a job. Must match an earlier `acquire`.
+        /// @note Thread-safe.
+        static void release(std::span<const ComponentID> ids, std::span<const bool> writes);
+    };
+} // namespace Firework::Internal
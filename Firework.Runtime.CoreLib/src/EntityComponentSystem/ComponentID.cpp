@@ -0,0 +1,48 @@
+#include "ComponentID.h"
+
+#include <mutex>
+#include <robin_hood.h>
+#include <vector>
+
+using namespace Firework;
+using namespace Firework::Internal;
+
+namespace
+{
+    struct Registry
+    {
+        std::mutex lock;
+        robin_hood::unordered_flat_map<std::type_index, ComponentID> ids;
+        std::vector<std::type_index> types;
+    };
+
+    // Constructed on first use, since components can be registered from static initializers in other modules.
+    Registry& registry()
+    {
+        static Registry ret;
+        return ret;
+    }
+} // namespace
+
+ComponentID ComponentRegistry::idOf(std::type_index type)
+{
+    Registry& registry = ::registry();
+    std::lock_guard guard(registry.lock);
+    auto [it, inserted] = registry.ids.emplace(type, ComponentID(registry.types.size()));
+    if (inserted)
+        registry.types.emplace_back(type);
+    return it->second;
+}
+ComponentID ComponentRegistry::find(std::type_index type)
+{
+    Registry& registry = ::registry();
+    std::lock_guard guard(registry.lock);
+    auto it = registry.ids.find(type);
+    return it != registry.ids.end() ? it->second : NullComponentID;
+}
+std::type_index ComponentRegistry::typeOf(ComponentID id)
+{
+    Registry& registry = ::registry();
+    std::lock_guard guard(registry.lock);
+    return registry.types[id];
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Firework.Runtime.CoreLib.Exports.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <typeindex>
+
+namespace Firework
+{
+    /// @brief Dense ID of a component type, usable as an index into per-type tables. Assigned on first use, so IDs differ between runs.
+    using ComponentID = uint32_t;
+    /// @brief ID no component type has.
+    constexpr ComponentID NullComponentID = ~ComponentID(0);
+} // namespace Firework
+
+namespace Firework::Internal
+{
+    /// @internal
+    /// @brief Internal API. Static class assigning `ComponentID`s to component types, keyed by `std::type_index` so every module agrees on them.
+    class _fw_core_api ComponentRegistry final
+    {
+    public:
+        ComponentRegistry() = delete;
+
+        /// @internal
+        /// @brief Internal API. Retrieve the ID of a component type, assigning it one if it has none yet.
+        /// @note Thread-safe. Takes a lock, use `componentID<T>()` instead, which caches the result.
+        static ComponentID idOf(std::type_index type);
+        /// @internal
+        /// @brief Internal API. Retrieve the ID of a component type, without assigning one.
+        /// @return The ID, or `NullComponentID` if the type has never been used as a component.
+        /// @note Thread-safe. Takes a lock.
+        static ComponentID find(std::type_index type);
+        /// @internal
+        /// @brief Internal API. Retrieve the type a component ID was assigned to.
+        /// @param id ID of the component type. Must have been assigned.
+        /// @note Thread-safe. Takes a lock.
+        static std::type_index typeOf(ComponentID id);
+    };
+} // namespace Firework::Internal
+
+namespace Firework
+{
+    /// @brief Retrieve the ID of a component type.
+    /// @tparam T Component type.
+    /// @return Dense ID of the type. The first call per module registers the type, after that it's a cached load.
+    /// @note Thread-safe.
+    template <typename T>
+    inline ComponentID componentID()
+    {
+        static const ComponentID id = Internal::ComponentRegistry::idOf(std::type_index(typeid(std::remove_cvref_t<T>)));
+        return id;
+    }
+} // namespace Firework
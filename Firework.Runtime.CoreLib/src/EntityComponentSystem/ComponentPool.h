@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include <Firework/Config.h>
+
+namespace Firework::Internal
+{
+    /// @internal
+    /// @brief Internal API. Static pool of fixed-size blocks, which components of every type with the given size and alignment are allocated from.
+    /// Blocks are carved out of chunks of `Config::ComponentPoolChunkSize` bytes, which are never freed, so blocks never move and freed ones are reused for the next
+    /// allocation rather than returned to the heap.
+    /// @tparam Size Size of each block.
+    /// @tparam Align Alignment of each block.
+    template <size_t Size, size_t Align>
+    class ComponentPool final
+    {
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        constexpr static size_t BlockAlign = std::max(Align, alignof(FreeBlock));
+        constexpr static size_t BlockSize = (std::max(Size, sizeof(FreeBlock)) + BlockAlign - 1) / BlockAlign * BlockAlign;
+        constexpr static size_t BlocksPerChunk = std::max<size_t>(Config::ComponentPoolChunkSize / BlockSize, 1);
+
+        // Only touched by the main thread.
+        inline static FreeBlock* freeBlocks = nullptr;
+        // Blocks freed from any thread, taken over by the main thread all at once when it runs out. Only ever pushed to or swapped out whole, so it can't suffer ABA.
+        // Both are constant-initialized and trivially destructible, so blocks may be freed at any point during static destruction.
+        inline static std::atomic<FreeBlock*> returnedBlocks = nullptr;
+    public:
+        ComponentPool() = delete;
+
+        /// @internal
+        /// @brief Internal API. Allocate a block.
+        /// @return The uninitialized block.
+        /// @throws std::bad_alloc A new chunk was needed and couldn't be allocated.
+        /// @note Main thread only.
+        inline static void* allocate()
+        {
+            if (!ComponentPool::freeBlocks) [[unlikely]]
+            {
+                ComponentPool::freeBlocks = ComponentPool::returnedBlocks.exchange(nullptr, std::memory_order_acquire);
+                if (!ComponentPool::freeBlocks)
+                {
+                    std::byte* chunk = static_cast<std::byte*>(::operator new(BlockSize * BlocksPerChunk, std::align_val_t(BlockAlign)));
+                    for (size_t i = BlocksPerChunk; i > 0; i--)
+                        ComponentPool::freeBlocks = new (chunk + (i - 1) * BlockSize) FreeBlock { .next = ComponentPool::freeBlocks };
+                }
+            }
+
+            FreeBlock* ret = ComponentPool::freeBlocks;
+            ComponentPool::freeBlocks = ret->next;
+            return ret;
+        }
+        /// @internal
+        /// @brief Internal API. Free a block for reuse.
+        /// @param block Block from `ComponentPool::allocate`, with its contents destroyed.
+        /// @note Thread-safe. Lock-free.
+        inline static void deallocate(void* block) noexcept
+        {
+            FreeBlock* freed = new (block) FreeBlock { .next = ComponentPool::returnedBlocks.load(std::memory_order_relaxed) };
+            while (!ComponentPool::returnedBlocks.compare_exchange_weak(freed->next, freed, std::memory_order_release, std::memory_order_relaxed));
+        }
+    };
+
+    /// @internal
+    /// @brief Internal API. Allocator drawing single objects from the `ComponentPool` of their size and alignment, for `std::allocate_shared` to put a component and
+    /// its control block in one pooled block. Arrays fall back to the heap.
+    /// @note Allocation is main thread only, deallocation is thread-safe.
+    template <typename T>
+    struct ComponentAllocator
+    {
+        using value_type = T;
+
+        ComponentAllocator() = default;
+        template <typename U>
+        constexpr ComponentAllocator(const ComponentAllocator<U>&) noexcept
+        { }
+
+        inline T* allocate(size_t n)
+        {
+            if (n != 1) [[unlikely]]
+                return std::allocator<T>().allocate(n);
+            return static_cast<T*>(ComponentPool<sizeof(T), alignof(T)>::allocate());
+        }
+        inline void deallocate(T* ptr, size_t n) noexcept
+        {
+            if (n != 1) [[unlikely]]
+                return std::allocator<T>().deallocate(ptr, n);
+            ComponentPool<sizeof(T), alignof(T)>::deallocate(ptr);
+        }
+
+        template <typename U>
+        constexpr friend bool operator==(const ComponentAllocator&, const ComponentAllocator<U>&) noexcept
+        {
+            return true;
+        }
+    };
+} // namespace Firework::Internal
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <robin_hood.h>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Firework
+{
+    class Entity;
+} // namespace Firework
+
+namespace Firework::Internal
+{
+    /// @internal
+    /// @brief Internal API. Change tracking of a single component.
+    struct ComponentVersion
+    {
+        /// Change version the component was last added or written at.
+        uint64_t changed = 0;
+    };
+    /// @internal
+    /// @brief Internal API. A component allocated together with its change tracking, so either can be reached from a pointer held alongside the other.
+    template <typename T>
+    struct VersionedComponent
+    {
+        ComponentVersion version;
+        T component;
+    };
+
+    /// @internal
+    /// @brief Internal API. Sparse set of the components of a single type.
+    /// Components are packed densely, so iterating a set is linear, alongside the entity each belongs to. A sparse map takes an entity to its dense index.
+    /// @note Removal swaps the last component into the hole, so dense order is only insertion order until something is removed.
+    class ComponentSet final
+    {
+        std::vector<Entity*> denseEntities;
+        std::vector<std::shared_ptr<void>> denseComponents;
+        std::vector<ComponentVersion*> denseVersions;
+        robin_hood::unordered_flat_map<Entity*, size_t> sparse;
+        uint64_t _lastChanged = 0;
+    public:
+        ComponentSet() = default;
+        ComponentSet(const ComponentSet&) = delete;
+        ComponentSet(ComponentSet&&) = default;
+
+        ComponentSet& operator=(const ComponentSet&) = delete;
+        ComponentSet& operator=(ComponentSet&&) = default;
+
+        /// @brief Retrieve the number of components in the set.
+        inline size_t size() const
+        {
+            return this->denseComponents.size();
+        }
+        /// @brief Retrieve whether the set has no components.
+        inline bool empty() const
+        {
+            return this->denseComponents.empty();
+        }
+
+        /// @brief Retrieve the latest change version any component in the set was stamped with. Never goes back, even once that component is removed.
+        inline uint64_t lastChanged() const
+        {
+            return this->_lastChanged;
+        }
+        /// @brief Record that some component in the set was stamped with a change version.
+        inline void markChanged(uint64_t version)
+        {
+            if (version > this->_lastChanged)
+                this->_lastChanged = version;
+        }
+
+        /// @brief Find the dense index of the component belonging to an entity.
+        /// @param entity Entity to find the component of.
+        /// @return The index, or `size_t(-1)` if the entity has none in this set. Invalidated by adding or removing components.
+        inline size_t indexOf(Entity* entity) const
+        {
+            auto it = this->sparse.find(entity);
+            return it != this->sparse.end() ? it->second : size_t(-1);
+        }
+        /// @brief Find the component belonging to an entity.
+        /// @param entity Entity to find the component of.
+        /// @return The component, or `nullptr` if the entity has none in this set. Invalidated by adding or removing components.
+        inline std::shared_ptr<void>* find(Entity* entity)
+        {
+            size_t index = this->indexOf(entity);
+            return index != size_t(-1) ? &this->denseComponents[index] : nullptr;
+        }
+        /// @brief Retrieve whether an entity has a component in this set.
+        inline bool contains(Entity* entity) const
+        {
+            return this->sparse.contains(entity);
+        }
+
+        /// @brief Add a component for an entity.
+        /// @param entity Entity the component belongs to. Must not already have a component in this set.
+        /// @param component Component to add.
+        /// @param version Change tracking of the component, allocated with it.
+        /// @param changed Change version to stamp the component with.
+        /// @return The added component. Invalidated by adding or removing components.
+        inline std::shared_ptr<void>& emplace(Entity* entity, std::shared_ptr<void> component, ComponentVersion* version, uint64_t changed)
+        {
+            version->changed = changed;
+            this->markChanged(changed);
+
+            this->sparse.emplace(entity, this->denseComponents.size());
+            this->denseEntities.emplace_back(entity);
+            this->denseVersions.emplace_back(version);
+            return this->denseComponents.emplace_back(std::move(component));
+        }
+        /// @brief Remove the component belonging to an entity, if it has one, without releasing it.
+        /// @param entity Entity to remove the component of.
+        /// @return The removed component, or `nullptr` if there was none.
+        inline std::shared_ptr<void> extract(Entity* entity)
+        {
+            auto it = this->sparse.find(entity);
+            if (it == this->sparse.end())
+                return nullptr;
+
+            size_t index = it->second;
+            this->sparse.erase(it);
+
+            std::shared_ptr<void> removed = std::move(this->denseComponents[index]);
+            if (index != this->denseComponents.size() - 1)
+            {
+                this->denseEntities[index] = this->denseEntities.back();
+                this->denseComponents[index] = std::move(this->denseComponents.back());
+                this->denseVersions[index] = this->denseVersions.back();
+                this->sparse[this->denseEntities[index]] = index;
+            }
+            this->denseEntities.pop_back();
+            this->denseComponents.pop_back();
+            this->denseVersions.pop_back();
+            return removed;
+        }
+        /// @brief Remove the component belonging to an entity, if it has one.
+        /// @param entity Entity to remove the component of.
+        /// @return Whether there was a component to remove.
+        inline bool erase(Entity* entity)
+        {
+            // Keep the component alive until the set is consistent again, in case its destructor touches this set.
+            std::shared_ptr<void> removed = this->extract(entity);
+            return removed != nullptr;
+        }
+        /// @brief Remove the components of every entity matching a predicate, in one pass over the set. Keeps the dense order of the rest.
+        /// @param pred Predicate taking the entity.
+        /// @param removed Receives the removed components, unreleased.
+        inline void eraseIf(auto&& pred, std::vector<std::shared_ptr<void>>& removed)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < this->denseEntities.size(); i++)
+            {
+                if (pred(this->denseEntities[i]))
+                {
+                    this->sparse.erase(this->denseEntities[i]);
+                    removed.emplace_back(std::move(this->denseComponents[i]));
+                    continue;
+                }
+
+                if (kept != i)
+                {
+                    this->denseEntities[kept] = this->denseEntities[i];
+                    this->denseComponents[kept] = std::move(this->denseComponents[i]);
+                    this->denseVersions[kept] = this->denseVersions[i];
+                    this->sparse[this->denseEntities[kept]] = kept;
+                }
+                ++kept;
+            }
+            this->denseEntities.resize(kept);
+            this->denseComponents.resize(kept);
+            this->denseVersions.resize(kept);
+        }
+        /// @brief Remove every component.
+        inline void clear()
+        {
+            std::vector<std::shared_ptr<void>> removed = std::exchange(this->denseComponents, {});
+            this->denseEntities.clear();
+            this->denseVersions.clear();
+            this->sparse.clear();
+        }
+
+        /// @brief Retrieve the entities with a component in this set, in dense order.
+        inline std::span<Entity* const> entities() const
+        {
+            return this->denseEntities;
+        }
+        /// @brief Retrieve the components in this set, in dense order. Parallel to `ComponentSet::entities`.
+        inline std::span<std::shared_ptr<void>> components()
+        {
+            return this->denseComponents;
+        }
+        /// @brief Retrieve the change tracking of the components in this set, in dense order. Parallel to `ComponentSet::entities`.
+        inline std::span<ComponentVersion* const> versions() const
+        {
+            return this->denseVersions;
+        }
+    };
+} // namespace Firework::Internal
@@ -1,5 +1,7 @@
 #include "EngineEvent.h"
 
+#include <deque>
+
 #include <EntityComponentSystem/Entity.h>
 #include <GL/Renderer.h>
 
@@ -35,6 +37,26 @@ FuncPtrEvent<> EngineEvent::OnQuit;
 // Runs in main thread.
 FuncPtrEvent<std::type_index, Entity&, std::shared_ptr<void>, ssz> InternalEngineEvent::OnRenderOffloadForComponent;
 FuncPtrEvent<std::type_index, Entity&, std::shared_ptr<void>, ssz> InternalEngineEvent::OnLateRenderOffloadForComponent;
-// Runs in render thread. Note FuncPtrEvent is not thread-safe,
-// so make sure you modify this event _before_ the main thread loop exits.
-FuncPtrEvent<> InternalEngineEvent::OnRenderShutdown;
+// Indexed by `ComponentID`. Deques, so adding a type never moves the events of others, and constructed on first use, since handlers are subscribed from static
+// initializers in other modules.
+static std::deque<FuncPtrEvent<Entity&, void*, ssz>>& renderOffloadEvents(bool late)
+{
+    static std::deque<FuncPtrEvent<Entity&, void*, ssz>> events[2];
+    return events[late];
+}
+static FuncPtrEvent<Entity&, void*, ssz>& renderOffloadEvent(ComponentID id, bool late)
+{
+    std::deque<FuncPtrEvent<Entity&, void*, ssz>>& events = renderOffloadEvents(late);
+    while (events.size() <= id) events.emplace_back();
+    return events[id];
+}
+FuncPtrEvent<Entity&, void*, ssz>& InternalEngineEvent::OnRenderOffloadFor(ComponentID id)
+{
+    return renderOffloadEvent(id, false);
+}
+FuncPtrEvent<Entity&, void*, ssz>& InternalEngineEvent::OnLateRenderOffloadFor(ComponentID id)
+{
+    return renderOffloadEvent(id, true);
+}
+// Runs in render thread.
+ConcurrentFuncPtrEvent<> InternalEngineEvent::OnRenderShutdown;
@@ -9,6 +9,7 @@
 #include <typeindex>
 
 #include <Core/Input.h>
+#include <EntityComponentSystem/ComponentID.h>
 #include <Library/Event.h>
 
 _push_nowarn_msvc(_clWarn_msvc_export_interface);
@@ -114,13 +115,32 @@ namespace Firework::Internal
         InternalEngineEvent() = delete;
 
         /// @internal
-        /// @note Main thread only.
+        /// @brief Low-level API. Event raised for every component of every entity, in hierarchy order, when a frame is offloaded to the render thread.
+        /// Render jobs queued from a handler are recorded into the frame, in order.
+        /// @note Raised concurrently from the main thread and worker threads, for different components. Handlers must only modify the component they were given, and
+        /// must not add or remove entities or components, nor subscribe to or unsubscribe from the render offload events. Other components may only be read through
+        /// const accessors, such as `RectTransform::matrix`.
         static FuncPtrEvent<std::type_index, Entity&, std::shared_ptr<void>, ssz> OnRenderOffloadForComponent;
         /// @internal
-        /// @brief Low-level API. Event raised immediately before the render thread exits.
-        /// @note Render thread only.
+        /// @brief Low-level API. Event raised for every component of every entity, in reverse hierarchy order, after `OnRenderOffloadForComponent`.
+        /// @note Same threading rules as `OnRenderOffloadForComponent`.
         static FuncPtrEvent<std::type_index, Entity&, std::shared_ptr<void>, ssz> OnLateRenderOffloadForComponent;
-        static FuncPtrEvent<> OnRenderShutdown;
+        /// @internal
+        /// @brief Low-level API. Retrieve the event raised in place of `OnRenderOffloadForComponent` for components of a single type.
+        /// Handlers are found by indexing with the `ComponentID`, rather than every handler testing the `std::type_index` of every component, so prefer this for
+        /// handling specific types. The component is passed without a reference of its own, and must not be retained.
+        /// @param id ID of the component type, from `componentID<T>()`.
+        /// @note Same threading rules as `OnRenderOffloadForComponent`. Subscribe from the main thread, outside the render offload.
+        static FuncPtrEvent<Entity&, void*, ssz>& OnRenderOffloadFor(ComponentID id);
+        /// @internal
+        /// @brief Low-level API. Retrieve the event raised in place of `OnLateRenderOffloadForComponent` for components of a single type.
+        /// @param id ID of the component type, from `componentID<T>()`.
+        /// @note Same threading rules as `OnRenderOffloadFor`.
+        static FuncPtrEvent<Entity&, void*, ssz>& OnLateRenderOffloadFor(ComponentID id);
+        /// @internal
+        /// @brief Low-level API. Event raised immediately before the render thread exits.
+        /// @note Raised on the render thread. May be subscribed to from any thread, at any time.
+        static ConcurrentFuncPtrEvent<> OnRenderShutdown;
     };
 } // namespace Firework::Internal
 
@@ -1,85 +1,108 @@
 #include "Entity.h"
 
+#include <Core/Debug.h>
 #include <EntityComponentSystem/EntityManagement.h>
 
 using namespace Firework;
 using namespace Firework::Internal;
 
-std::shared_ptr<Entity> Entity::alloc(std::shared_ptr<Entity> parent)
+EntityHandle Entity::alloc(EntityHandle parent)
 {
-    std::shared_ptr<Entity> ret = std::shared_ptr<Entity>(new Entity());
-    ret->reparentAfterOrphan(parent);
-    return ret;
+    Entity& ret = Entities::allocSlot();
+    ret.reparentAfterOrphan(parent);
+    return ret._handle;
 }
-Entity::~Entity()
+void Entity::destroy()
 {
+    // Already being destroyed as part of a batch, which frees it itself.
+    if (Entities::slots[this->_handle.index()].dying)
+        return;
+
     this->clear();
+    this->orphan();
+    Entities::hierarchyErase(*this);
+    Entities::freeSlot(this->_handle.index());
 }
 void Entity::clear()
 {
-    this->_childrenFront = nullptr;
-    this->_childrenBack = nullptr;
-    this->orphan();
-    for (auto& [typeIndex, componentTable] : Entities::table) componentTable.erase(this);
+    // Destroyed as one batch, so the descendants come out of the hierarchy in a single pass.
+    std::vector<EntityHandle> children;
+    for (Entity& child : this->children()) children.emplace_back(child._handle);
+    Entities::destroy(children);
+    this->removeComponents();
 }
-
-void Entity::orphan() noexcept
+void Entity::removeComponents()
 {
-    if (this->_parent)
+    std::vector<ComponentID>& components = Entities::slots[this->_handle.index()].components;
+    while (!components.empty())
     {
-        if (this->_parent->_childrenFront.get() == this)
-            this->_parent->_childrenFront = this->next;
-        if (this->_parent->_childrenBack.get() == this)
-            this->_parent->_childrenBack = this->prev;
+        ComponentID id = components.back();
+        Entities::componentRemoving(id, *this);
+        Entities::table[id]->erase(this);
     }
+}
+
+std::shared_ptr<void> Entity::getComponent(std::type_index type)
+{
+    ComponentID id = ComponentRegistry::find(type);
+    ComponentSet* componentSet = id != NullComponentID ? Entities::componentSet(id) : nullptr;
+    if (!componentSet)
+        return nullptr;
+
+    std::shared_ptr<void>* component = componentSet->find(this);
+    return component ? *component : nullptr;
+}
+
+void Entity::orphan() noexcept
+{
+    Entities::hierarchyDetach(*this);
+
+    uint32_t& front = this->_parent != EntityHandle::NullIndex ? Entities::at(this->_parent)._childrenFront : Entities::front;
+    uint32_t& back = this->_parent != EntityHandle::NullIndex ? Entities::at(this->_parent)._childrenBack : Entities::back;
+    if (front == this->_handle.index())
+        front = this->next;
+    if (back == this->_handle.index())
+        back = this->prev;
+
+    if (this->prev != EntityHandle::NullIndex)
+        Entities::at(this->prev).next = this->next;
+    if (this->next != EntityHandle::NullIndex)
+        Entities::at(this->next).prev = this->prev;
+    this->prev = EntityHandle::NullIndex;
+    this->next = EntityHandle::NullIndex;
+    this->_parent = EntityHandle::NullIndex;
+}
+void Entity::reparentAfterOrphan(EntityHandle newParent) noexcept
+{
+    Entity* parent = Entities::get(newParent);
+    uint32_t& front = parent ? parent->_childrenFront : Entities::front;
+    uint32_t& back = parent ? parent->_childrenBack : Entities::back;
+    if (back == EntityHandle::NullIndex)
+        front = this->_handle.index();
     else
     {
-        if (Entities::front.get() == this)
-            Entities::front = this->next;
-        if (Entities::back.get() == this)
-            Entities::back = this->prev;
+        Entities::at(back).next = this->_handle.index();
+        this->prev = back;
     }
+    back = this->_handle.index();
+    this->_parent = parent ? newParent.index() : EntityHandle::NullIndex;
 
-    std::shared_ptr<Entity> before = this->prev;
-    std::shared_ptr<Entity> after = this->next;
-    if (before)
-        before->next = after;
-    if (after)
-        after->prev = before;
-    this->prev = nullptr;
-    this->next = nullptr;
-    this->_parent = nullptr;
+    Entities::hierarchyAttach(*this);
 }
-void Entity::reparentAfterOrphan(std::shared_ptr<Entity> newParent) noexcept
+void Entity::setParent(EntityHandle value)
 {
-    std::shared_ptr<Entity> _this = shared_from_this();
-    if (newParent)
-    {
-        if (newParent->_childrenBack == nullptr)
-        {
-            newParent->_childrenFront = _this;
-            newParent->_childrenBack = _this;
-        }
-        else
-        {
-            newParent->_childrenBack->next = _this;
-            this->prev = newParent->_childrenBack;
-            newParent->_childrenBack = _this;
-        }
-        this->_parent = newParent;
-    }
-    else
+    // The subtree of an entity is a contiguous run of `Entities::hierarchy`, starting at the entity itself, so a new parent within it would form a cycle.
+    if (Entities::get(value))
     {
-        if (Entities::back == nullptr)
+        size_t position = Entities::hierarchyPosition(this->_handle.index());
+        size_t parentPosition = Entities::hierarchyPosition(value.index());
+        if (parentPosition >= position && parentPosition < position + Entities::hierarchySizes[position]) [[unlikely]]
         {
-            Entities::front = _this;
-            Entities::back = _this;
-        }
-        else
-        {
-            Entities::back->next = _this;
-            this->prev = Entities::back;
-            Entities::back = _this;
+            Debug::logError("Entity can't be parented to itself or one of its descendants.");
+            return;
         }
     }
+
+    this->orphan();
+    this->reparentAfterOrphan(value);
 }
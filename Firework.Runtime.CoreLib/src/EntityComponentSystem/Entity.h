@@ -2,14 +2,18 @@
 
 #include "Firework.Runtime.CoreLib.Exports.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <module/sys>
 #include <robin_hood.h>
 #include <type_traits>
 #include <typeindex>
 
+#include <EntityComponentSystem/ComponentPool.h>
 #include <EntityComponentSystem/EntityManagement.inc>
+#include <Firework/Config.h>
 #include <Library/Property.h>
 
 _push_nowarn_msvc(_clWarn_msvc_export_interface);
@@ -23,7 +27,7 @@ namespace Firework
         using value_type = Entity;
 
         EntityIterator() = default;
-        EntityIterator(std::shared_ptr<Entity> entity) : current(std::move(entity))
+        EntityIterator(Entity* entity) : current(entity)
         { }
 
         inline value_type& operator*()
@@ -32,7 +36,7 @@ namespace Firework
         }
         inline value_type* operator->()
         {
-            return this->current.get();
+            return this->current;
         }
 
         constexpr friend bool operator==(const EntityIterator&, const EntityIterator&) = default;
@@ -52,7 +56,7 @@ namespace Firework
             return ret;
         }
     private:
-        std::shared_ptr<Entity> current = nullptr;
+        Entity* current = nullptr;
     };
     struct EntityRange
     {
@@ -70,45 +74,69 @@ namespace Firework
             return !this->front;
         }
 
-        EntityRange(std::shared_ptr<Entity> front) : front(std::move(front))
+        EntityRange(Entity* front) : front(front)
         { }
     private:
-        std::shared_ptr<Entity> front = nullptr;
+        Entity* front = nullptr;
     };
 
-    class _fw_core_api Entity final : public std::enable_shared_from_this<Entity>
+    /// @brief An entity in the hierarchy, which components attach to.
+    /// Entities are pooled, and link to each other by pool slot rather than by pointer. Hold on to an `EntityHandle` rather than a reference, if the entity may be
+    /// destroyed in the meantime.
+    /// @note Main thread only.
+    class _fw_core_api Entity final
     {
-        std::shared_ptr<Entity> next = nullptr;
-        std::shared_ptr<Entity> prev = nullptr;
+        EntityHandle _handle;
 
-        std::shared_ptr<Entity> _parent = nullptr;
-        std::shared_ptr<Entity> _childrenFront = nullptr;
-        std::shared_ptr<Entity> _childrenBack = nullptr;
+        uint32_t next = EntityHandle::NullIndex;
+        uint32_t prev = EntityHandle::NullIndex;
+
+        uint32_t _parent = EntityHandle::NullIndex;
+        uint32_t _childrenFront = EntityHandle::NullIndex;
+        uint32_t _childrenBack = EntityHandle::NullIndex;
 
         Entity() noexcept = default;
+        ~Entity() = default;
 
         void orphan() noexcept;
-        void reparentAfterOrphan(std::shared_ptr<Entity> newParent) noexcept;
+        void reparentAfterOrphan(EntityHandle newParent) noexcept;
+        inline EntityHandle getParent() const noexcept
+        {
+            return this->_parent != EntityHandle::NullIndex ? Entities::at(this->_parent)._handle : EntityHandle();
+        }
+        void setParent(EntityHandle value);
+        void removeComponents();
 
         template <typename T, bool Get, bool Add>
         requires (Get || Add)
         inline std::shared_ptr<T> fetchComponent();
     public:
-        const Property<std::shared_ptr<Entity>, std::shared_ptr<Entity>> parent { [this]() -> std::shared_ptr<Entity> { return this->_parent; },
-                                                                                  [this](std::shared_ptr<Entity> value)
-        {
-            std::shared_ptr<Entity> lease = shared_from_this();
-            this->orphan();
-            this->reparentAfterOrphan(value);
-        } };
+        Entity(const Entity&) = delete;
+        Entity(Entity&&) = delete;
 
-        static std::shared_ptr<Entity> alloc(std::shared_ptr<Entity> parent = nullptr);
-        ~Entity();
+        Entity& operator=(const Entity&) = delete;
+        Entity& operator=(Entity&&) = delete;
+
+        _fw_property(Entity, parent, EntityHandle, EntityHandle, &Entity::getParent, &Entity::setParent);
+
+        /// @brief Create an entity.
+        /// @param parent Entity to create it as the last child of. A root entity is created if this is null or has been destroyed.
+        /// @return Handle to the new entity.
+        static EntityHandle alloc(EntityHandle parent = EntityHandle());
+        /// @brief Destroy this entity, its descendants, and all of their components. References to any of them are invalid afterwards.
+        void destroy();
+        /// @brief Destroy the descendants of this entity, and remove all of its components.
         void clear();
 
+        /// @brief Retrieve a handle to this entity.
+        inline EntityHandle handle() const noexcept
+        {
+            return this->_handle;
+        }
+
         inline EntityIterator childrenBegin()
         {
-            return EntityIterator(this->_childrenFront);
+            return EntityIterator(Entities::atOrNull(this->_childrenFront));
         }
         inline EntityIterator childrenEnd()
         {
@@ -116,8 +144,15 @@ namespace Firework
         }
         inline EntityRange children()
         {
-            return EntityRange(this->_childrenFront);
+            return EntityRange(Entities::atOrNull(this->_childrenFront));
         }
+        /// @brief Retrieve the number of descendants of this entity, children and their descendants.
+        inline size_t descendantCount() noexcept;
+        /// @brief Invoke a function for every descendant of this entity, parents before their children, and siblings in order.
+        /// @param func Function to invoke with each descendant. May return `bool`, where `false` skips the descendant's own descendants.
+        /// @note `func` must not create, destroy, or reparent entities.
+        inline void forEachDescendant(auto&& func)
+        requires requires(Entity& entity) { func(entity); };
 
         template <typename T>
         inline std::shared_ptr<T> addComponent();
@@ -127,21 +162,94 @@ namespace Firework
         inline std::shared_ptr<T> getOrAddComponent();
         template <typename T>
         inline bool removeComponent();
+        /// @brief Stamp a component of this entity as changed, for `Entities::forEachChanged`.
+        /// @tparam T Type of the component.
+        /// @return Whether this entity has a component of the type.
+        template <typename T>
+        inline bool markChanged();
+        /// @brief Retrieve whether a component of this entity has been added or changed since a change version.
+        /// @tparam T Type of the component.
+        /// @param since Version from `Entities::markChangeVersion` or `Entities::frameChangeVersion`.
+        /// @return Whether it has changed. `false` if this entity has no component of the type.
+        template <typename T>
+        inline bool changedSince(uint64_t since);
+        /// @brief Retrieve a component by its runtime type. Slow path for consumers that don't know component types statically, prefer `getComponent<T>()`.
+        /// @param type Type of the component.
+        /// @return The component, or `nullptr` if this entity has none of that type.
+        std::shared_ptr<void> getComponent(std::type_index type);
 
         friend struct Firework::EntityIterator;
         friend class Firework::Entities;
+        friend class Firework::EntitySnapshot;
 
         friend class Firework::Internal::CoreEngine;
     };
 
+    Entity& Entities::at(uint32_t index) noexcept
+    {
+        return Entities::pages[index / Config::EntityPoolPageSize].get()[index % Config::EntityPoolPageSize];
+    }
+    Entity* Entities::atOrNull(uint32_t index) noexcept
+    {
+        return index != EntityHandle::NullIndex ? &Entities::at(index) : nullptr;
+    }
+    Entity* Entities::get(EntityHandle handle) noexcept
+    {
+        if (handle.index() >= Entities::slots.size())
+            return nullptr;
+
+        const Internal::EntitySlot& slot = Entities::slots[handle.index()];
+        return slot.alive && slot.generation == handle.generation() ? &Entities::at(handle.index()) : nullptr;
+    }
+    void Entities::componentAdded(ComponentID id, Entity& entity)
+    {
+        Entities::slots[entity._handle.index()].components.emplace_back(id);
+        if (id < Entities::queriesByComponent.size() && !Entities::queriesByComponent[id].empty())
+            Entities::matchQueries(id, entity);
+    }
+    void Entities::componentRemoving(ComponentID id, Entity& entity)
+    {
+        // Searched from the back, since removing every component of an entity goes back to front.
+        std::vector<ComponentID>& components = Entities::slots[entity._handle.index()].components;
+        auto it = std::find(components.rbegin(), components.rend(), id);
+        if (it != components.rend())
+        {
+            *it = components.back();
+            components.pop_back();
+        }
+
+        if (id < Entities::queriesByComponent.size())
+        {
+            for (Internal::QueryCache* cache : Entities::queriesByComponent[id]) cache->erase(&entity);
+        }
+    }
+
+    size_t Entity::descendantCount() noexcept
+    {
+        return Entities::hierarchySizes[Entities::hierarchyPosition(this->_handle.index())] - 1u;
+    }
+
+    Entity* EntityHandle::get() const noexcept
+    {
+        return Entities::get(*this);
+    }
+    Entity* EntityHandle::operator->() const noexcept
+    {
+        return Entities::get(*this);
+    }
+    Entity& EntityHandle::operator*() const noexcept
+    {
+        return *Entities::get(*this);
+    }
+
     EntityIterator& EntityIterator::operator++()
     {
-        this->current = this->current->next;
+        this->current = Entities::atOrNull(this->current->next);
         return *this;
     }
     EntityIterator& EntityIterator::operator--()
     {
-        this->current = this->current->prev;
+        this->current = Entities::atOrNull(this->current->prev);
         return *this;
     }
 
@@ -149,32 +257,35 @@ namespace Firework
     requires (Get || Add)
     std::shared_ptr<T> Entity::fetchComponent()
     {
-        auto componentSetIt = Entities::table.emplace(std::type_index(typeid(T)), robin_hood::unordered_map<Entity*, std::shared_ptr<void>>()).first;
-        sys::sc_act contractKeeper([&]
+        if constexpr (!Add)
         {
-            if (componentSetIt->second.empty()) [[unlikely]]
-                Entities::table.erase(componentSetIt);
-        });
-
-        auto it = componentSetIt->second.find(this);
-        if (it != componentSetIt->second.end())
-        {
-            if constexpr (Get)
-                return std::static_pointer_cast<T>(it->second);
-            else
+            Internal::ComponentSet* componentSet = Entities::componentSet(componentID<T>());
+            if (!componentSet) [[unlikely]]
                 return nullptr;
-        }
 
-        if constexpr (Add)
+            std::shared_ptr<void>* component = componentSet->find(this);
+            return component ? std::static_pointer_cast<T>(*component) : nullptr;
+        }
+        else
         {
-            std::shared_ptr<T> ret = std::make_shared<T>();
-            componentSetIt->second.emplace(robin_hood::pair(this, std::static_pointer_cast<void>(ret)));
+            Internal::ComponentSet& componentSet = Entities::componentSetOrAdd(componentID<T>());
+            if (std::shared_ptr<void>* component = componentSet.find(this))
+            {
+                if constexpr (Get)
+                    return std::static_pointer_cast<T>(*component);
+                else
+                    return nullptr;
+            }
+
+            std::shared_ptr<Internal::VersionedComponent<T>> allocation =
+                std::allocate_shared<Internal::VersionedComponent<T>>(Internal::ComponentAllocator<Internal::VersionedComponent<T>>());
+            std::shared_ptr<T> ret(allocation, &allocation->component);
+            componentSet.emplace(this, ret, &allocation->version, Entities::changeVersion);
+            Entities::componentAdded(componentID<T>(), *this);
             if constexpr (requires { ret->onAttach(*this); })
                 ret->onAttach(*this);
             return ret;
         }
-        else
-            return nullptr;
     }
 
     template <typename T>
@@ -193,21 +304,53 @@ namespace Firework
         return this->fetchComponent<T, true, true>();
     }
 
+    template <typename T>
+    bool Entity::markChanged()
+    {
+        Internal::ComponentSet* componentSet = Entities::componentSet(componentID<T>());
+        size_t index = componentSet ? componentSet->indexOf(this) : size_t(-1);
+        if (index == size_t(-1))
+            return false;
+
+        componentSet->versions()[index]->changed = Entities::changeVersion;
+        componentSet->markChanged(Entities::changeVersion);
+        return true;
+    }
+    template <typename T>
+    void Entities::markChanged(T& component) noexcept
+    {
+        // Components are only ever allocated after their version, as a `VersionedComponent`.
+        _fw_property_push_nowarn_offsetof();
+        const size_t offset = offsetof(Internal::VersionedComponent<T>, component);
+        _fw_property_pop_nowarn_offsetof();
+        reinterpret_cast<Internal::VersionedComponent<T>*>(reinterpret_cast<char*>(&component) - offset)->version.changed = Entities::changeVersion;
+        Entities::componentSet(componentID<T>())->markChanged(Entities::changeVersion);
+    }
+    template <typename T>
+    bool Entity::changedSince(uint64_t since)
+    {
+        Internal::ComponentSet* componentSet = Entities::componentSet(componentID<T>());
+        if (!componentSet || componentSet->lastChanged() <= since)
+            return false;
+
+        size_t index = componentSet->indexOf(this);
+        return index != size_t(-1) && componentSet->versions()[index]->changed > since;
+    }
     template <typename T>
     bool Entity::removeComponent()
     {
-        auto componentSetIt = Entities::table.find(std::type_index(typeid(T)));
-        if (componentSetIt == Entities::table.end()) [[unlikely]]
+        Internal::ComponentSet* componentSet = Entities::componentSet(componentID<T>());
+        if (!componentSet) [[unlikely]]
             return false;
 
-        auto componentIt = componentSetIt->second.find(this);
-        if (componentIt == componentSetIt->second.end())
+        std::shared_ptr<void>* component = componentSet->find(this);
+        if (!component)
             return false;
-        if (componentIt->second.use_count() > 1)
+        if (component->use_count() > 1)
             return false;
 
-        componentSetIt->second.erase(componentIt);
-        return true;
+        Entities::componentRemoving(componentID<T>(), *this);
+        return componentSet->erase(this);
     }
 } // namespace Firework
 _pop_nowarn_msvc();
@@ -0,0 +1,76 @@
+#include "EntityCommandBuffer.h"
+
+#include <concurrentqueue.h>
+
+using namespace Firework;
+using namespace Firework::Internal;
+
+static moodycamel::ConcurrentQueue<EntityCommandBuffer> submittedBuffers;
+
+EntityCommandBuffer::PendingEntity EntityCommandBuffer::create(Target parent)
+{
+    PendingEntity ret { .index = this->pendingCount++ };
+    this->commands.emplace_back(Command { .type = CommandType::Create, .target = ret, .parent = parent });
+    return ret;
+}
+void EntityCommandBuffer::destroy(Target entity)
+{
+    this->commands.emplace_back(Command { .type = CommandType::Destroy, .target = entity });
+}
+
+void EntityCommandBuffer::playback()
+{
+    std::vector<EntityHandle> created(this->pendingCount);
+    std::vector<EntityHandle> destroying;
+    auto resolve = [&](Target target) -> EntityHandle
+    {
+        if (target.pending)
+            return created[target.value];
+
+        EntityHandle ret;
+        ret.value = target.value;
+        return ret;
+    };
+
+    // Taken first, so commands recorded into this buffer while it plays back are kept for the next playback rather than invalidating the iteration.
+    std::vector<Command> commands = std::exchange(this->commands, {});
+    this->pendingCount = 0;
+    for (Command& command : commands)
+    {
+        if (command.type == CommandType::Destroy)
+        {
+            destroying.emplace_back(resolve(command.target));
+            continue;
+        }
+
+        // Anything else may depend on whether those entities still exist.
+        if (!destroying.empty())
+        {
+            Entities::destroy(destroying);
+            destroying.clear();
+        }
+
+        if (command.type == CommandType::Create)
+            created[command.target.value] = Entity::alloc(resolve(command.parent));
+        else if (Entity* entity = Entities::get(resolve(command.target)))
+            command.apply(*entity);
+    }
+    if (!destroying.empty())
+        Entities::destroy(destroying);
+}
+void EntityCommandBuffer::submit(EntityCommandBuffer&& buffer)
+{
+    if (!buffer.empty())
+        submittedBuffers.enqueue(std::move(buffer));
+}
+
+void EntityCommandBuffer::playbackSubmitted()
+{
+    EntityCommandBuffer buffer;
+    while (submittedBuffers.try_dequeue(buffer)) buffer.playback();
+}
+void EntityCommandBuffer::discardSubmitted()
+{
+    EntityCommandBuffer buffer;
+    while (submittedBuffers.try_dequeue(buffer));
+}
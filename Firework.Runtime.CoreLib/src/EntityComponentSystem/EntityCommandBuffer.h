@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Firework.Runtime.CoreLib.Exports.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <function.h>
+#include <utility>
+#include <vector>
+
+#include <EntityComponentSystem/EntityManagement.h>
+
+_push_nowarn_msvc(_clWarn_msvc_export_interface);
+
+namespace Firework::Internal
+{
+    class CoreEngine;
+} // namespace Firework::Internal
+
+namespace Firework
+{
+    /// @brief Records structural changes to entities, to be played back later on the main thread.
+    /// Record from any thread, including worker threads and mid-traversal, then either `EntityCommandBuffer::submit` the buffer to have it played back at the end of the
+    /// frame's logic, or play it back yourself. Commands are played back in the order they were recorded in, and consecutive destroys are played back as a single
+    /// batch.
+    /// @note A single buffer is not thread-safe, record into one buffer per thread.
+    class _fw_core_api EntityCommandBuffer final
+    {
+    public:
+        /// @brief An entity created by a command buffer, which only exists once the buffer is played back. Only valid in later commands of the same buffer.
+        struct PendingEntity
+        {
+            uint32_t index;
+        };
+        /// @brief The entity a command applies to, either an existing entity, or one created earlier in the same buffer.
+        struct Target
+        {
+            inline Target(EntityHandle handle) noexcept : value(handle.value), pending(false)
+            { }
+            inline Target(PendingEntity entity) noexcept : value(entity.index), pending(true)
+            { }
+        private:
+            uint32_t value;
+            bool pending;
+
+            friend class Firework::EntityCommandBuffer;
+        };
+    private:
+        enum class CommandType : uint8_t
+        {
+            Create,
+            Destroy,
+            Apply
+        };
+        struct Command
+        {
+            CommandType type;
+            Target target;
+            Target parent = EntityHandle();
+            func::function<void(Entity&)> apply = nullptr;
+        };
+
+        std::vector<Command> commands;
+        uint32_t pendingCount = 0;
+
+        static void playbackSubmitted();
+        static void discardSubmitted();
+    public:
+        EntityCommandBuffer() = default;
+        EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+        EntityCommandBuffer(EntityCommandBuffer&&) = default;
+
+        EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+        EntityCommandBuffer& operator=(EntityCommandBuffer&&) = default;
+
+        /// @brief Retrieve the number of commands recorded.
+        inline size_t size() const noexcept
+        {
+            return this->commands.size();
+        }
+        /// @brief Retrieve whether no commands are recorded.
+        inline bool empty() const noexcept
+        {
+            return this->commands.empty();
+        }
+
+        /// @brief Record creating an entity.
+        /// @param parent Entity to create it as the last child of. A root entity is created if this is null or has been destroyed by the time the command is played back.
+        /// @return The entity, for use in later commands of this buffer.
+        PendingEntity create(Target parent = EntityHandle());
+        /// @brief Record destroying an entity, its descendants, and all of their components. Does nothing if it has already been destroyed by then.
+        void destroy(Target entity);
+        /// @brief Record adding a component to an entity. Does nothing if the entity has been destroyed, or already has a component of the type, by then.
+        /// @tparam T Type of the component.
+        /// @param entity Entity to add the component to.
+        /// @param init Function to initialize the added component with.
+        template <typename T>
+        inline void addComponent(Target entity, func::function<void(T&)> init = nullptr);
+        /// @brief Record removing a component from an entity, as `Entity::removeComponent` would.
+        /// @tparam T Type of the component.
+        template <typename T>
+        inline void removeComponent(Target entity);
+
+        /// @brief Play back and clear the recorded commands.
+        /// @note Main thread only.
+        void playback();
+        /// @brief Queue a buffer to be played back on the main thread, after `EngineEvent::OnLateTick` of the current or next frame.
+        /// Buffers submitted from the same thread are played back in the order they were submitted in.
+        /// @param buffer Buffer to play back.
+        /// @note Thread-safe.
+        static void submit(EntityCommandBuffer&& buffer);
+
+        friend class Firework::Internal::CoreEngine;
+    };
+
+    template <typename T>
+    void EntityCommandBuffer::addComponent(Target entity, func::function<void(T&)> init)
+    {
+        this->commands.emplace_back(Command { .type = CommandType::Apply, .target = entity, .apply = [init = std::move(init)](Entity& entity)
+        {
+            std::shared_ptr<T> component = entity.addComponent<T>();
+            if (component && init)
+                init(*component);
+        } });
+    }
+    template <typename T>
+    void EntityCommandBuffer::removeComponent(Target entity)
+    {
+        this->commands.emplace_back(Command { .type = CommandType::Apply, .target = entity, .apply = [](Entity& entity) { (void)entity.removeComponent<T>(); } });
+    }
+} // namespace Firework
+
+_pop_nowarn_msvc();
@@ -1,11 +1,301 @@
 #include "EntityManagement.h"
 
+#include <algorithm>
+#include <new>
+
 #include <EntityComponentSystem/Entity.h>
 
 using namespace Firework;
 using namespace Firework::Internal;
 
-robin_hood::unordered_map<std::type_index, robin_hood::unordered_map<Entity*, std::shared_ptr<void>>> Entities::table;
+std::vector<std::unique_ptr<ComponentSet>> Entities::table;
+std::vector<std::unique_ptr<QueryCache>> Entities::queries;
+std::vector<std::vector<QueryCache*>> Entities::queriesByComponent;
+uint64_t Entities::changeVersion = 1;
+uint64_t Entities::frameStartChangeVersion = 0;
+
+std::vector<std::unique_ptr<Entity, EntityPageDeleter>> Entities::pages;
+std::vector<EntitySlot> Entities::slots;
+std::vector<uint32_t> Entities::freeSlots;
+size_t Entities::aliveCount = 0;
+
+uint32_t Entities::front = EntityHandle::NullIndex;
+uint32_t Entities::back = EntityHandle::NullIndex;
+
+std::vector<uint32_t> Entities::hierarchy;
+std::vector<uint32_t> Entities::hierarchySizes;
+size_t Entities::hierarchyNumbered = 0;
+
+void EntityPageDeleter::operator()(Entity* page) const noexcept
+{
+    ::operator delete(page, std::align_val_t(alignof(Entity)));
+}
+
+Entity& Entities::allocSlot()
+{
+    uint32_t index;
+    if (!Entities::freeSlots.empty())
+    {
+        index = Entities::freeSlots.back();
+        Entities::freeSlots.pop_back();
+    }
+    else
+    {
+        if (Entities::slots.size() >= EntityHandle::NullIndex) [[unlikely]]
+            throw std::bad_alloc();
+
+        index = uint32_t(Entities::slots.size());
+        if (index % Config::EntityPoolPageSize == 0)
+            Entities::pages.emplace_back(static_cast<Entity*>(::operator new(sizeof(Entity) * Config::EntityPoolPageSize, std::align_val_t(alignof(Entity)))));
+        Entities::slots.emplace_back();
+    }
+
+    EntitySlot& slot = Entities::slots[index];
+    slot.alive = true;
+    ++Entities::aliveCount;
+
+    slot.hierarchyPosition = uint32_t(Entities::hierarchy.size());
+    Entities::hierarchy.emplace_back(index);
+    Entities::hierarchySizes.emplace_back(1);
+    if (Entities::hierarchyNumbered == slot.hierarchyPosition)
+        ++Entities::hierarchyNumbered;
+
+    Entity* ret = new (&Entities::at(index)) Entity();
+    ret->_handle = EntityHandle(index, slot.generation);
+    return *ret;
+}
+void Entities::freeSlot(uint32_t index)
+{
+    Entities::at(index).~Entity();
+
+    EntitySlot& slot = Entities::slots[index];
+    slot.alive = false;
+    slot.generation = uint16_t((slot.generation + 1u) & EntityHandle::GenerationMask);
+    --Entities::aliveCount;
+    Entities::freeSlots.emplace_back(index);
+}
+
+void Entities::numberHierarchy() noexcept
+{
+    for (size_t i = Entities::hierarchyNumbered; i < Entities::hierarchy.size(); i++) Entities::slots[Entities::hierarchy[i]].hierarchyPosition = uint32_t(i);
+    Entities::hierarchyNumbered = Entities::hierarchy.size();
+}
+void Entities::hierarchyDetach(Entity& entity) noexcept
+{
+    uint32_t size = Entities::hierarchySizes[Entities::hierarchyPosition(entity._handle.index())];
+    for (uint32_t ancestor = entity._parent; ancestor != EntityHandle::NullIndex; ancestor = Entities::at(ancestor)._parent)
+        Entities::hierarchySizes[Entities::hierarchyPosition(ancestor)] -= size;
+}
+void Entities::hierarchyAttach(Entity& entity) noexcept
+{
+    size_t position = Entities::hierarchyPosition(entity._handle.index());
+    size_t size = Entities::hierarchySizes[position];
+
+    // Where the subtree goes, counted as if it had already been taken out. The parent's size doesn't include it yet, so it's contiguous counted that way.
+    size_t target = Entities::hierarchy.size() - size;
+    if (entity._parent != EntityHandle::NullIndex)
+    {
+        size_t parentPosition = Entities::hierarchyPosition(entity._parent);
+        target = (parentPosition < position ? parentPosition : parentPosition - size) + Entities::hierarchySizes[parentPosition];
+    }
+
+    if (target != position)
+    {
+        auto rotate = [&](std::vector<uint32_t>& entries)
+        {
+            if (target > position)
+                std::rotate(entries.begin() + ptrdiff_t(position), entries.begin() + ptrdiff_t(position + size), entries.begin() + ptrdiff_t(target + size));
+            else
+                std::rotate(entries.begin() + ptrdiff_t(target), entries.begin() + ptrdiff_t(position), entries.begin() + ptrdiff_t(position + size));
+        };
+        rotate(Entities::hierarchy);
+        rotate(Entities::hierarchySizes);
+
+        // Only the rotated run has moved, and everything was numbered to find `position`, so renumbering the run keeps every position current.
+        size_t last = std::max(position, target) + size;
+        for (size_t i = std::min(position, target); i < last; i++) Entities::slots[Entities::hierarchy[i]].hierarchyPosition = uint32_t(i);
+    }
+
+    for (uint32_t ancestor = entity._parent; ancestor != EntityHandle::NullIndex; ancestor = Entities::at(ancestor)._parent)
+        Entities::hierarchySizes[Entities::hierarchyPosition(ancestor)] += uint32_t(size);
+}
+void Entities::hierarchyErase(Entity& entity) noexcept
+{
+    size_t position = Entities::hierarchyPosition(entity._handle.index());
+    Entities::hierarchy.erase(Entities::hierarchy.begin() + ptrdiff_t(position));
+    Entities::hierarchySizes.erase(Entities::hierarchySizes.begin() + ptrdiff_t(position));
+    Entities::hierarchyNumbered = std::min(Entities::hierarchyNumbered, position);
+}
+
+ComponentSet& Entities::componentSetOrAdd(ComponentID id)
+{
+    if (id >= Entities::table.size())
+        Entities::table.resize(size_t(id) + 1);
+    if (!Entities::table[id])
+        Entities::table[id] = std::make_unique<ComponentSet>();
+    return *Entities::table[id];
+}
+
+QueryCache& Entities::queryCache(std::span<const ComponentID> ids)
+{
+    for (std::unique_ptr<QueryCache>& cache : Entities::queries)
+    {
+        if (std::ranges::equal(cache->ids(), ids))
+            return *cache;
+    }
+
+    QueryCache& ret = *Entities::queries.emplace_back(std::make_unique<QueryCache>(std::vector<ComponentID>(ids.begin(), ids.end())));
+    for (ComponentID id : ids)
+    {
+        if (id >= Entities::queriesByComponent.size())
+            Entities::queriesByComponent.resize(size_t(id) + 1);
+        std::vector<QueryCache*>& caches = Entities::queriesByComponent[id];
+        if (std::ranges::find(caches, &ret) == caches.end())
+            caches.emplace_back(&ret);
+    }
+
+    // Fill from the smallest set, probing the others.
+    ComponentSet* smallest = nullptr;
+    for (ComponentID id : ids)
+    {
+        ComponentSet* componentSet = Entities::componentSet(id);
+        if (!componentSet || componentSet->empty())
+            return ret;
+        if (!smallest || componentSet->size() < smallest->size())
+            smallest = componentSet;
+    }
+    for (Entity* entity : smallest->entities()) Entities::matchQuery(ret, *entity);
+    return ret;
+}
+void Entities::matchQueries(ComponentID id, Entity& entity)
+{
+    for (QueryCache* cache : Entities::queriesByComponent[id])
+    {
+        if (!cache->contains(&entity))
+            Entities::matchQuery(*cache, entity);
+    }
+}
+void Entities::matchQuery(QueryCache& cache, Entity& entity)
+{
+    // Main thread only, so the scratch space can be shared.
+    static std::vector<void*> components;
+    static std::vector<ComponentVersion*> versions;
+    components.clear();
+    versions.clear();
+    for (ComponentID id : cache.ids())
+    {
+        ComponentSet* componentSet = Entities::componentSet(id);
+        size_t index = componentSet ? componentSet->indexOf(&entity) : size_t(-1);
+        if (index == size_t(-1))
+            return;
+        components.emplace_back(componentSet->components()[index].get());
+        versions.emplace_back(componentSet->versions()[index]);
+    }
+    cache.insert(&entity, components, versions);
+}
+
+void Entities::destroy(std::span<const EntityHandle> handles)
+{
+    // Mark every entity in the batch and its descendants, breadth first. Descendants already marked were listed themselves, and collected with their own subtree.
+    std::vector<uint32_t> dying;
+    for (EntityHandle handle : handles)
+    {
+        if (!Entities::get(handle) || Entities::slots[handle.index()].dying)
+            continue;
+
+        size_t begin = dying.size();
+        Entities::slots[handle.index()].dying = true;
+        dying.emplace_back(handle.index());
+        for (size_t i = begin; i < dying.size(); i++)
+        {
+            for (Entity* child = Entities::atOrNull(Entities::at(dying[i])._childrenFront); child; child = Entities::atOrNull(child->next))
+            {
+                if (!Entities::slots[child->_handle.index()].dying)
+                {
+                    Entities::slots[child->_handle.index()].dying = true;
+                    dying.emplace_back(child->_handle.index());
+                }
+            }
+        }
+    }
+    if (dying.empty())
+        return;
+
+    auto isDying = [](Entity* entity) { return Entities::slots[entity->_handle.index()].dying; };
+    // Compacting a set or cache costs a pass over all of it, removing entities one by one costs a lookup each. Compact once the batch is a large enough share.
+    auto shouldCompact = [](size_t removing, size_t size) { return removing * 4 >= size; };
+
+    for (std::unique_ptr<QueryCache>& cache : Entities::queries)
+    {
+        if (cache->size() == 0)
+            continue;
+
+        if (shouldCompact(dying.size(), cache->size()))
+            cache->eraseIf(isDying);
+        else
+        {
+            for (uint32_t index : dying) cache->erase(&Entities::at(index));
+        }
+    }
+
+    // Components are only released once every set is consistent again, since their destructors may touch the sets.
+    std::vector<std::shared_ptr<void>> released;
+    std::vector<size_t> removing(Entities::table.size(), 0);
+    for (uint32_t index : dying)
+    {
+        for (ComponentID id : Entities::slots[index].components) ++removing[id];
+    }
+    std::vector<bool> compact(Entities::table.size());
+    for (ComponentID id = 0; id < removing.size(); id++) compact[id] = removing[id] && shouldCompact(removing[id], Entities::table[id]->size());
+
+    for (uint32_t index : dying)
+    {
+        for (ComponentID id : Entities::slots[index].components)
+        {
+            if (!compact[id])
+                released.emplace_back(Entities::table[id]->extract(&Entities::at(index)));
+        }
+        Entities::slots[index].components.clear();
+    }
+    for (ComponentID id = 0; id < compact.size(); id++)
+    {
+        if (compact[id])
+            Entities::table[id]->eraseIf(isDying, released);
+    }
+
+    // Only the topmost entities of the batch need unlinking, the rest go down with them. Done before any component is released, so the hierarchy is consistent again
+    // should a component destructor touch it.
+    for (uint32_t index : dying)
+    {
+        Entity& entity = Entities::at(index);
+        if (entity._parent == EntityHandle::NullIndex || !Entities::slots[entity._parent].dying)
+            entity.orphan();
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < Entities::hierarchy.size(); i++)
+    {
+        if (Entities::slots[Entities::hierarchy[i]].dying)
+        {
+            Entities::hierarchyNumbered = std::min(Entities::hierarchyNumbered, kept);
+            continue;
+        }
+
+        Entities::hierarchy[kept] = Entities::hierarchy[i];
+        Entities::hierarchySizes[kept] = Entities::hierarchySizes[i];
+        ++kept;
+    }
+    Entities::hierarchy.resize(kept);
+    Entities::hierarchySizes.resize(kept);
+
+    released.clear();
+
+    for (uint32_t index : dying)
+    {
+        // A component destructor may have added components back.
+        if (!Entities::slots[index].components.empty()) [[unlikely]]
+            Entities::at(index).removeComponents();
 
-std::shared_ptr<Entity> Entities::front = nullptr;
-std::shared_ptr<Entity> Entities::back = nullptr;
+        Entities::slots[index].dying = false;
+        Entities::freeSlot(index);
+    }
+}
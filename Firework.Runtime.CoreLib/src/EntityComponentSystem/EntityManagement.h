@@ -4,8 +4,11 @@
 
 #include <iostream>
 #include <robin_hood.h>
+#include <type_traits>
 #include <typeindex>
+#include <vector>
 
+#include <Core/Scheduler.h>
 #include <EntityComponentSystem/Entity.h>
 #include <EntityComponentSystem/EntityManagement.inc>
 
@@ -13,7 +16,7 @@ namespace Firework
 {
     inline EntityIterator Entities::begin()
     {
-        return EntityIterator(Entities::front);
+        return EntityIterator(Entities::atOrNull(Entities::front));
     }
     inline EntityIterator Entities::end()
     {
@@ -21,56 +24,182 @@ namespace Firework
     }
     inline EntityRange Entities::range()
     {
-        return EntityRange(Entities::front);
+        return EntityRange(Entities::atOrNull(Entities::front));
     }
 
+    inline void Entities::forEachEntityIn(size_t begin, size_t end, auto&& func)
+    {
+        for (size_t i = begin; i < end;)
+        {
+            Entity& entity = Entities::at(Entities::hierarchy[i]);
+            if constexpr (std::is_same_v<decltype(func(entity)), bool>)
+            {
+                if (!func(entity))
+                {
+                    i += Entities::hierarchySizes[i];
+                    continue;
+                }
+            }
+            else
+                func(entity);
+            ++i;
+        }
+    }
     inline void Entities::forEachEntity(auto&& func)
     requires requires(Entity& entity) { func(entity); }
     {
-        auto recurse = [&](auto&& recurse, Entity& entity) -> void
-        {
-            func(entity);
-            for (Entity& child : entity.children()) recurse(recurse, child);
-        };
-        for (Entity& entity : Entities::range()) recurse(recurse, entity);
+        Entities::forEachEntityIn(0, Entities::hierarchy.size(), func);
     }
     inline void Entities::forEachEntityReversed(auto&& func)
     requires requires(Entity& entity) { func(entity); }
     {
-        auto recurse = [&](auto&& recurse, Entity& entity) -> void
+        // Subtrees are still contiguous, just visited last sibling first. Siblings are found by jumping over subtrees, and pushed in order so the last pops first.
+        std::vector<uint32_t> pending;
+        auto pushChildren = [&](size_t begin, size_t end)
         {
-            func(entity);
-            for (std::shared_ptr<Entity> child = entity._childrenBack; child; child = child->prev) recurse(recurse, *child);
+            for (size_t i = begin; i < end; i += Entities::hierarchySizes[i]) pending.emplace_back(uint32_t(i));
         };
-        for (std::shared_ptr<Entity> entity = Entities::back; entity; entity = entity->prev) recurse(recurse, *entity);
+        pushChildren(0, Entities::hierarchy.size());
+        while (!pending.empty())
+        {
+            size_t position = pending.back();
+            pending.pop_back();
+            func(Entities::at(Entities::hierarchy[position]));
+            pushChildren(position + 1, position + Entities::hierarchySizes[position]);
+        }
+    }
+    inline void Entity::forEachDescendant(auto&& func)
+    requires requires(Entity& entity) { func(entity); }
+    {
+        size_t position = Entities::hierarchyPosition(this->_handle.index());
+        Entities::forEachEntityIn(position + 1, position + Entities::hierarchySizes[position], func);
+    }
+
+    template <typename... Ts>
+    requires (sizeof...(Ts) > 0)
+    inline Query<Ts...> Entities::query()
+    {
+        static Internal::QueryCache& cache = []() -> Internal::QueryCache&
+        {
+            const ComponentID ids[] { componentID<Ts>()... };
+            return Entities::queryCache(ids);
+        }();
+        return Query<Ts...>(cache);
     }
     template <typename... Ts>
     inline void Entities::forEach(auto&& func)
     requires requires(Entity& entity, Ts&... components) { func(entity, components...); }
     {
-        const auto invokeForEach = [&]<size_t... Is>(std::index_sequence<Is...>)
+        if constexpr (sizeof...(Ts) == 0u)
+            Entities::forEachEntity(func);
+        else
+            Entities::query<Ts...>().forEach(func);
+    }
+
+    template <typename... Ts>
+    requires (sizeof...(Ts) > 0)
+    inline void Entities::forEachChanged(uint64_t since, auto&& func)
+    requires requires(Entity& entity, Ts&... components) { func(entity, components...); }
+    {
+        Entities::query<Ts...>().forEachChanged(since, func);
+    }
+    template <Internal::ComponentAccessSpecifier... As>
+    requires (sizeof...(As) > 0)
+    inline void Entities::forEachParallel(auto&& func, size_t grain)
+    requires requires(Entity& entity, typename Internal::ComponentAccessTraits<As>::Reference... components) { func(entity, components...); }
+    {
+        // Otherwise the access checks would flag the call as conflicting with itself.
+        static_assert(Internal::DistinctComponentAccess<As...>, "Each component type can only be accessed once per call, either through `Read<T>` or `Write<T>`.");
+
+        Internal::QueryCache& cache = *Entities::query<typename Internal::ComponentAccessTraits<As>::Type...>().cache;
+        const ComponentID ids[] { componentID<typename Internal::ComponentAccessTraits<As>::Type>()... };
+        const bool writes[] { Internal::ComponentAccessTraits<As>::Writes... };
+
+#if FIREWORK_ECS_ACCESS_CHECKS
+        Internal::ComponentAccessChecker::acquire(ids, writes);
+        struct Release
         {
-            if constexpr (sizeof...(Ts) == 0u)
-                Entities::forEachEntity(func);
-            else
+            const ComponentID (&ids)[sizeof...(As)];
+            const bool (&writes)[sizeof...(As)];
+
+            inline ~Release()
             {
-                const decltype(Entities::table)::iterator componentTable[] { Entities::table.find(std::type_index(typeid(Ts)))... };
-                for (auto& query : componentTable)
-                    if (query == Entities::table.end()) [[unlikely]]
-                        return;
+                Internal::ComponentAccessChecker::release(this->ids, this->writes);
+            }
+        } release { ids, writes };
+#endif
+
+        // Sets are stamped up front, components as they're visited. Each component is only visited by one chunk, so stamping it doesn't race.
+        const uint64_t version = Entities::changeVersion;
+        for (size_t i = 0; i < sizeof...(As); i++)
+        {
+            Internal::ComponentSet* componentSet = Entities::componentSet(ids[i]);
+            if (writes[i] && componentSet && cache.size())
+                componentSet->markChanged(version);
+        }
 
-                Entities::forEachEntity([&](Entity& entity)
+        const auto invokeForEach = [&]<size_t... Is>(std::index_sequence<Is...>)
+        {
+            Scheduler::parallelFor(0, cache.size(), grain, [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++)
                 {
-                    decltype((**componentTable).second.find(nullptr)) components[sizeof...(Ts)];
-                    for (size_t i = 0; i < sizeof...(Ts); i++)
-                    {
-                        components[i] = componentTable[i]->second.find(&entity);
-                        if (components[i] == componentTable[i]->second.end())
-                            return;
-                    }
+                    void* const* components = cache.components(i);
+                    Internal::ComponentVersion* const* versions = cache.versions(i);
+                    ((Internal::ComponentAccessTraits<As>::Writes ? void(versions[Is]->changed = version) : void()), ...);
+                    func(*cache.entity(i), *static_cast<typename Internal::ComponentAccessTraits<As>::Type*>(components[Is])...);
+                }
+            });
+        };
+        invokeForEach(std::index_sequence_for<As...>());
+    }
+
+    template <typename... Ts>
+    inline void Query<Ts...>::forEach(auto&& func)
+    requires requires(Entity& entity, Ts&... components) { func(entity, components...); }
+    {
+        const auto invokeForEach = [&]<size_t... Is>(std::index_sequence<Is...>)
+        {
+            // Indexed rather than iterated, since `func` may add or remove matches. If it removes the current one, the last match is swapped into its place, so visit
+            // that index again.
+            for (size_t i = 0; i < this->cache->size();)
+            {
+                Entity* entity = this->cache->entity(i);
+                void* const* components = this->cache->components(i);
+                func(*entity, *static_cast<Ts*>(components[Is])...);
+                if (i < this->cache->size() && this->cache->entity(i) == entity)
+                    ++i;
+            }
+        };
+        invokeForEach(std::index_sequence_for<Ts...>());
+    }
+    template <typename... Ts>
+    inline void Query<Ts...>::forEachChanged(uint64_t since, auto&& func)
+    requires requires(Entity& entity, Ts&... components) { func(entity, components...); }
+    {
+        bool anyChanged = false;
+        for (ComponentID id : { componentID<Ts>()... })
+        {
+            Internal::ComponentSet* componentSet = Entities::componentSet(id);
+            anyChanged |= componentSet && componentSet->lastChanged() > since;
+        }
+        if (!anyChanged)
+            return;
 
-                    func(entity, *std::static_pointer_cast<Ts>(components[Is]->second)...);
-                });
+        const auto invokeForEach = [&]<size_t... Is>(std::index_sequence<Is...>)
+        {
+            // Same revisiting as `Query::forEach`.
+            for (size_t i = 0; i < this->cache->size();)
+            {
+                Entity* entity = this->cache->entity(i);
+                Internal::ComponentVersion* const* versions = this->cache->versions(i);
+                if ((... || (versions[Is]->changed > since)))
+                {
+                    void* const* components = this->cache->components(i);
+                    func(*entity, *static_cast<Ts*>(components[Is])...);
+                }
+                if (i < this->cache->size() && this->cache->entity(i) == entity)
+                    ++i;
             }
         };
         invokeForEach(std::index_sequence_for<Ts...>());
@@ -0,0 +1,259 @@
+#include "EntitySnapshot.h"
+
+#include <algorithm>
+#include <robin_hood.h>
+
+#include <Components/EntityAttributes.h>
+#include <Components/RectTransform.h>
+#include <Core/Debug.h>
+
+using namespace Firework;
+using namespace Firework::Internal;
+
+namespace
+{
+    struct ComponentSerializer
+    {
+        std::string name;
+        func::function<void(const void*, SnapshotWriter&)> write;
+        func::function<void(Entity&, SnapshotReader&)> read;
+    };
+    struct SerializerRegistry
+    {
+        std::vector<ComponentSerializer> serializers;
+        robin_hood::unordered_flat_map<std::string, size_t> byName;
+        // Indexed by `ComponentID`, `size_t(-1)` for types that aren't serializable.
+        std::vector<size_t> byComponent;
+    };
+
+    // Constructed on first use, since other modules register from their static initializers.
+    SerializerRegistry& serializerRegistry()
+    {
+        static SerializerRegistry ret;
+        return ret;
+    }
+    void addSerializer(std::string name, ComponentID id, func::function<void(const void*, SnapshotWriter&)> write, func::function<void(Entity&, SnapshotReader&)> read)
+    {
+        SerializerRegistry& registry = serializerRegistry();
+        if (registry.byName.contains(name) || (id < registry.byComponent.size() && registry.byComponent[id] != size_t(-1))) [[unlikely]]
+        {
+            Debug::logError("Component type `", ComponentRegistry::typeOf(id).name(), "` can't be registered for snapshots as \"", name,
+                            "\", either the name or the type is already registered.");
+            return;
+        }
+
+        if (id >= registry.byComponent.size())
+            registry.byComponent.resize(size_t(id) + 1, size_t(-1));
+        registry.byComponent[id] = registry.serializers.size();
+        registry.byName.emplace(name, registry.serializers.size());
+        registry.serializers.emplace_back(ComponentSerializer { .name = std::move(name), .write = std::move(write), .read = std::move(read) });
+    }
+
+    // Snapshot layout, every value little-endian:
+    //   Magic[4] | u32 version
+    //   u32 type count | per type: string name
+    //   u32 entity count | per entity, parents before their children:
+    //     u32 parent, as an index of an earlier entity, or ~0 for the root | u32 component count | per component: u32 type, as an index into the types | u32 size |
+    //     size bytes of state
+    // Sizes let types that aren't registered when restoring be skipped.
+    constexpr uint32_t NullParent = ~0u;
+} // namespace
+
+void EntitySnapshot::registerSerializer(std::string name, ComponentID id, func::function<void(const void*, SnapshotWriter&)> write,
+                                        func::function<void(Entity&, SnapshotReader&)> read)
+{
+    EntitySnapshot::registerBuiltinComponents();
+    addSerializer(std::move(name), id, std::move(write), std::move(read));
+}
+void EntitySnapshot::registerBuiltinComponents()
+{
+    static bool registered = []
+    {
+        addSerializer(
+            "Firework.EntityAttributes", componentID<EntityAttributes>(),
+            [](const void* component, SnapshotWriter& writer) { writer.write(static_cast<const EntityAttributes*>(component)->name); },
+            [](Entity& entity, SnapshotReader& reader) { entity.getOrAddComponent<EntityAttributes>()->name = reader.readString(); });
+        addSerializer(
+            "Firework.RectTransform", componentID<RectTransform>(), [](const void* component, SnapshotWriter& writer)
+        {
+            const RectTransform& rectTransform = *static_cast<const RectTransform*>(component);
+            for (const RectFloat& rect : { rectTransform._rect, rectTransform._anchor, rectTransform._positionAnchor })
+            {
+                writer.write(rect.top);
+                writer.write(rect.right);
+                writer.write(rect.bottom);
+                writer.write(rect.left);
+            }
+            writer.write(rectTransform._position.x);
+            writer.write(rectTransform._position.y);
+            writer.write(rectTransform._rotation);
+            writer.write(rectTransform._scale.x);
+            writer.write(rectTransform._scale.y);
+        },
+            [](Entity& entity, SnapshotReader& reader)
+        {
+            // Set directly rather than through the properties, which would propagate to descendants that are already restored as captured.
+            RectTransform& rectTransform = *entity.getOrAddComponent<RectTransform>();
+            for (RectFloat* rect : { &rectTransform._rect, &rectTransform._anchor, &rectTransform._positionAnchor })
+            {
+                rect->top = reader.read<float>();
+                rect->right = reader.read<float>();
+                rect->bottom = reader.read<float>();
+                rect->left = reader.read<float>();
+            }
+            rectTransform._position.x = reader.read<float>();
+            rectTransform._position.y = reader.read<float>();
+            rectTransform._rotation = reader.read<float>();
+            rectTransform._scale.x = reader.read<float>();
+            rectTransform._scale.y = reader.read<float>();
+            rectTransform._dirty = true;
+            rectTransform.matrixDirty = true;
+            Entities::markChanged(rectTransform);
+        });
+        return true;
+    }();
+    (void)registered;
+}
+
+EntitySnapshot EntitySnapshot::capture(EntityHandle root)
+{
+    if (!Entities::get(root))
+        return EntitySnapshot();
+
+    EntitySnapshot::registerBuiltinComponents();
+    SerializerRegistry& registry = serializerRegistry();
+
+    // Types are numbered as they're first met, so only the ones in use are listed.
+    std::vector<uint8_t> body;
+    SnapshotWriter bodyWriter(body);
+    std::vector<uint32_t> typeIndices(registry.serializers.size(), ~0u);
+    std::vector<size_t> types;
+
+    size_t begin = Entities::hierarchyPosition(root.index());
+    size_t count = Entities::hierarchySizes[begin];
+    bodyWriter.write(uint32_t(count));
+    for (size_t i = begin; i < begin + count; i++)
+    {
+        Entity& entity = Entities::at(Entities::hierarchy[i]);
+        bodyWriter.write(i == begin ? NullParent : uint32_t(Entities::hierarchyPosition(entity._parent) - begin));
+
+        size_t componentCountAt = body.size();
+        uint32_t componentCount = 0;
+        bodyWriter.write(componentCount);
+        for (ComponentID id : Entities::slots[Entities::hierarchy[i]].components)
+        {
+            size_t serializer = id < registry.byComponent.size() ? registry.byComponent[id] : size_t(-1);
+            if (serializer == size_t(-1))
+                continue;
+
+            if (typeIndices[serializer] == ~0u)
+            {
+                typeIndices[serializer] = uint32_t(types.size());
+                types.emplace_back(serializer);
+            }
+            bodyWriter.write(typeIndices[serializer]);
+
+            size_t sizeAt = body.size();
+            bodyWriter.write(uint32_t(0));
+            registry.serializers[serializer].write(Entities::table[id]->find(&entity)->get(), bodyWriter);
+            uint32_t size = uint32_t(body.size() - sizeAt - sizeof(uint32_t));
+            for (size_t j = 0; j < sizeof(uint32_t); j++) body[sizeAt + j] = uint8_t(size >> (j * 8));
+            ++componentCount;
+        }
+        for (size_t j = 0; j < sizeof(uint32_t); j++) body[componentCountAt + j] = uint8_t(componentCount >> (j * 8));
+    }
+
+    EntitySnapshot ret;
+    SnapshotWriter writer(ret.data);
+    ret.data.insert(ret.data.end(), std::begin(EntitySnapshot::Magic), std::end(EntitySnapshot::Magic));
+    writer.write(EntitySnapshot::Version);
+    writer.write(uint32_t(types.size()));
+    for (size_t serializer : types) writer.write(registry.serializers[serializer].name);
+    ret.data.insert(ret.data.end(), body.begin(), body.end());
+    return ret;
+}
+EntityHandle EntitySnapshot::restore(EntityHandle parent) const
+{
+    if (this->data.empty())
+        return EntityHandle();
+
+    EntitySnapshot::registerBuiltinComponents();
+    SerializerRegistry& registry = serializerRegistry();
+
+    SnapshotReader reader(this->data);
+    std::vector<EntityHandle> created;
+    auto fail = [&](const char* reason) -> EntityHandle
+    {
+        Debug::logError("Failed to restore entity snapshot, ", reason, '.');
+        if (!created.empty())
+            Entities::destroy(std::span(created.data(), 1));
+        return EntityHandle();
+    };
+
+    std::span<const uint8_t> magic = reader.take(std::size(EntitySnapshot::Magic));
+    if (magic.empty() || !std::equal(magic.begin(), magic.end(), std::begin(EntitySnapshot::Magic)))
+        return fail("it isn't a snapshot");
+    if (uint32_t version = reader.read<uint32_t>(); version != EntitySnapshot::Version)
+        return fail("its format version isn't supported");
+
+    // Counts are checked against what's left before anything is sized by them, every type takes at least 4 bytes and every entity at least 8.
+    auto remaining = [&] { return this->data.size() - reader.position; };
+
+    // Types that aren't registered map to null, and have their components skipped.
+    uint32_t typeCount = reader.read<uint32_t>();
+    if (reader.failed() || typeCount > remaining() / sizeof(uint32_t))
+        return fail("it's truncated");
+    std::vector<const ComponentSerializer*> types(typeCount);
+    for (const ComponentSerializer*& type : types)
+    {
+        std::string name = reader.readString();
+        auto it = registry.byName.find(name);
+        type = it != registry.byName.end() ? &registry.serializers[it->second] : nullptr;
+        if (!type && !reader.failed())
+            Debug::logWarn("Entity snapshot has components of type \"", name, "\", which isn't registered. They won't be restored.");
+    }
+
+    uint32_t entityCount = reader.read<uint32_t>();
+    if (reader.failed() || entityCount > remaining() / (2 * sizeof(uint32_t)))
+        return fail("it's truncated");
+
+    // The root is restored as a root first, so every entity is appended at the end of the hierarchy rather than moving everything after it, and only the finished
+    // subtree is moved into place.
+    created.reserve(entityCount);
+    for (uint32_t i = 0; i < entityCount; i++)
+    {
+        uint32_t parentIndex = reader.read<uint32_t>();
+        if (reader.failed())
+            return fail("it's truncated");
+        if (i == 0 ? parentIndex != NullParent : parentIndex >= i)
+            return fail("its hierarchy is malformed");
+        EntityHandle entity = Entity::alloc(i == 0 ? EntityHandle() : created[parentIndex]);
+        created.emplace_back(entity);
+
+        uint32_t componentCount = reader.read<uint32_t>();
+        for (uint32_t j = 0; j < componentCount; j++)
+        {
+            uint32_t type = reader.read<uint32_t>();
+            std::span<const uint8_t> state = reader.take(reader.read<uint32_t>());
+            if (reader.failed())
+                return fail("it's truncated");
+            if (type >= types.size())
+                return fail("it references a component type it doesn't list");
+            if (!types[type])
+                continue;
+
+            SnapshotReader stateReader(state);
+            types[type]->read(*entity, stateReader);
+            if (stateReader.failed())
+                return fail("a component's state is truncated");
+        }
+        if (reader.failed())
+            return fail("it's truncated");
+    }
+    if (created.empty())
+        return EntityHandle();
+
+    if (Entities::get(parent))
+        created.front()->parent = parent;
+    return created.front();
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "Firework.Runtime.CoreLib.Exports.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <function.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Core/PackageManager.h>
+#include <EntityComponentSystem/EntityManagement.h>
+
+_push_nowarn_msvc(_clWarn_msvc_export_interface);
+namespace Firework
+{
+    class EntitySnapshot;
+
+    /// @brief Stream a component is written to when captured into an `EntitySnapshot`. Values are stored little-endian, whatever the platform.
+    class _fw_core_api SnapshotWriter final
+    {
+        std::vector<uint8_t>& data;
+
+        inline explicit SnapshotWriter(std::vector<uint8_t>& data) : data(data)
+        { }
+    public:
+        /// @brief Write an arithmetic or enumeration value.
+        template <typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+        inline void write(T value)
+        {
+            if constexpr (std::is_enum_v<T>)
+                this->write(std::to_underlying(value));
+            else if constexpr (std::is_same_v<T, bool>)
+                this->write(uint8_t(value));
+            else if constexpr (std::is_floating_point_v<T>)
+                this->write(std::bit_cast<std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>>(value));
+            else
+            {
+                if constexpr (std::endian::native == std::endian::big)
+                    value = std::byteswap(value);
+                const size_t at = this->data.size();
+                this->data.resize(at + sizeof(T));
+                std::memcpy(this->data.data() + at, &value, sizeof(T));
+            }
+        }
+        /// @brief Write a string, prefixed with its length.
+        inline void write(std::string_view value)
+        {
+            this->write(uint32_t(value.size()));
+            this->data.insert(this->data.end(), value.begin(), value.end());
+        }
+        /// @brief Write a string, prefixed with its length.
+        inline void write(std::u32string_view value)
+        {
+            this->write(uint32_t(value.size()));
+            for (char32_t c : value) this->write(uint32_t(c));
+        }
+        /// @brief Write a string, prefixed with its length. Each code unit is stored in 32 bits, since `wchar_t` differs in size between platforms.
+        inline void write(std::wstring_view value)
+        {
+            this->write(uint32_t(value.size()));
+            for (wchar_t c : value) this->write(uint32_t(c));
+        }
+
+        friend class Firework::EntitySnapshot;
+    };
+    /// @brief Stream a component is read from when restored from an `EntitySnapshot`. Reading past the end of the component yields zeroed values and marks the stream
+    /// failed, which fails the restore.
+    class _fw_core_api SnapshotReader final
+    {
+        std::span<const uint8_t> data;
+        size_t position = 0;
+        bool _failed = false;
+
+        inline explicit SnapshotReader(std::span<const uint8_t> data) : data(data)
+        { }
+
+        inline std::span<const uint8_t> take(size_t size)
+        {
+            if (this->_failed || size > this->data.size() - this->position) [[unlikely]]
+            {
+                this->_failed = true;
+                return {};
+            }
+
+            std::span<const uint8_t> ret = this->data.subspan(this->position, size);
+            this->position += size;
+            return ret;
+        }
+        template <typename T>
+        inline static T decode(const uint8_t* bytes)
+        {
+            T ret;
+            std::memcpy(&ret, bytes, sizeof(T));
+            if constexpr (std::endian::native == std::endian::big)
+                ret = std::byteswap(ret);
+            return ret;
+        }
+        template <typename String>
+        inline String readWideString()
+        {
+            std::span<const uint8_t> bytes = this->take(size_t(this->read<uint32_t>()) * sizeof(uint32_t));
+            String ret(bytes.size() / sizeof(uint32_t), typename String::value_type());
+            for (size_t i = 0; i < ret.size(); i++) ret[i] = typename String::value_type(SnapshotReader::decode<uint32_t>(bytes.data() + i * sizeof(uint32_t)));
+            return ret;
+        }
+    public:
+        /// @brief Retrieve whether anything has been read past the end of the component.
+        inline bool failed() const noexcept
+        {
+            return this->_failed;
+        }
+
+        /// @brief Read an arithmetic or enumeration value.
+        template <typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+        inline T read()
+        {
+            if constexpr (std::is_enum_v<T>)
+                return T(this->read<std::underlying_type_t<T>>());
+            else if constexpr (std::is_same_v<T, bool>)
+                return this->read<uint8_t>() != 0;
+            else if constexpr (std::is_floating_point_v<T>)
+                return std::bit_cast<T>(this->read<std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>>());
+            else
+            {
+                std::span<const uint8_t> bytes = this->take(sizeof(T));
+                return bytes.empty() ? T() : SnapshotReader::decode<T>(bytes.data());
+            }
+        }
+        /// @brief Read a string written with `SnapshotWriter::write(std::string_view)`.
+        inline std::string readString()
+        {
+            std::span<const uint8_t> bytes = this->take(this->read<uint32_t>());
+            return std::string(bytes.begin(), bytes.end());
+        }
+        /// @brief Read a string written with `SnapshotWriter::write(std::u32string_view)`.
+        inline std::u32string readU32String()
+        {
+            return this->readWideString<std::u32string>();
+        }
+        /// @brief Read a string written with `SnapshotWriter::write(std::wstring_view)`.
+        inline std::wstring readWString()
+        {
+            return this->readWideString<std::wstring>();
+        }
+
+        friend class Firework::EntitySnapshot;
+    };
+
+    /// @brief Compact binary snapshot of an entity subtree and its serializable components, to build the subtree once and restore it in bulk.
+    /// Only components of types registered with `EntitySnapshot::registerComponent` are captured. `EntityAttributes` and `RectTransform` are registered by the
+    /// runtime, other modules register their own. Components are restored by writing their state directly, so restoring sets off no property propagation, and
+    /// `RectTransform`s come back with the world-space layout they were captured with.
+    /// Snapshots are loadable from packages, as `PackageSystem::EntitySnapshotPackageFile`.
+    class _fw_core_api EntitySnapshot final
+    {
+        std::vector<uint8_t> data;
+
+        static void registerSerializer(std::string name, ComponentID id, func::function<void(const void*, SnapshotWriter&)> write,
+                                       func::function<void(Entity&, SnapshotReader&)> read);
+        static void registerBuiltinComponents();
+    public:
+        /// @brief Leading bytes of every snapshot.
+        constexpr static uint8_t Magic[4] { 0x46, 0x57, 0x53, 0x4e };
+        /// @brief Format version snapshots are captured with. Snapshots of other versions fail to restore.
+        constexpr static uint32_t Version = 1;
+
+        EntitySnapshot() = default;
+        /// @brief Wrap the bytes of a snapshot, as returned by `EntitySnapshot::bytes`. They're validated on restore.
+        inline explicit EntitySnapshot(std::vector<uint8_t> data) : data(std::move(data))
+        { }
+
+        /// @brief Retrieve the bytes of the snapshot, to store and later wrap again.
+        inline const std::vector<uint8_t>& bytes() const noexcept
+        {
+            return this->data;
+        }
+        /// @brief Retrieve whether the snapshot holds no entities.
+        inline bool empty() const noexcept
+        {
+            return this->data.empty();
+        }
+
+        /// @brief Capture an entity, its descendants, and their serializable components.
+        /// @param root Entity to capture.
+        /// @return The snapshot, empty if `root` has been destroyed.
+        /// @note Main thread only.
+        static EntitySnapshot capture(EntityHandle root);
+        /// @brief Recreate the captured entities and components.
+        /// @param parent Entity to restore the captured root as the last child of. Restored as a root entity if this is null or has been destroyed.
+        /// @return The restored root, or a null handle if the snapshot is empty or malformed, in which case nothing is restored.
+        /// @note Main thread only. Components of types that aren't registered are skipped.
+        EntityHandle restore(EntityHandle parent = EntityHandle()) const;
+
+        /// @brief Register a component type as serializable.
+        /// @tparam T Type of the component.
+        /// @param name Name the type is stored under. Must be unique, and stay the same for snapshots to remain restorable.
+        /// @param write Function writing a component's state.
+        /// @param read Function reading a component's state back, written by `write`. Receives a component that was just added, or already attached by another
+        /// component's `onAttach`.
+        /// @note Not thread-safe. Register from static initializers or the main thread.
+        template <typename T>
+        inline static void registerComponent(std::string name, void (*write)(const T&, SnapshotWriter&), void (*read)(T&, SnapshotReader&))
+        {
+            EntitySnapshot::registerSerializer(
+                std::move(name), componentID<T>(), [write](const void* component, SnapshotWriter& writer) { write(*static_cast<const T*>(component), writer); },
+                [read](Entity& entity, SnapshotReader& reader)
+                {
+                    T& component = *entity.getOrAddComponent<T>();
+                    read(component, reader);
+                    Entities::markChanged(component);
+                });
+        }
+    };
+} // namespace Firework
+
+namespace Firework::PackageSystem
+{
+    /// @brief Package file for an entity snapshot, recognized by `EntitySnapshot::Magic`.
+    class _fw_core_api EntitySnapshotPackageFile final : public PackageFile
+    {
+        EntitySnapshot snapshot;
+    public:
+        EntitySnapshotPackageFile(std::vector<uint8_t>&& data) : snapshot(std::move(data))
+        { }
+
+        /// @brief Retrieve the snapshot.
+        /// @note Thread-safe.
+        const EntitySnapshot& entitySnapshot() const noexcept
+        {
+            return this->snapshot;
+        }
+    };
+} // namespace Firework::PackageSystem
+_pop_nowarn_msvc();
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <robin_hood.h>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <EntityComponentSystem/ComponentID.h>
+#include <EntityComponentSystem/ComponentSet.h>
+
+namespace Firework
+{
+    class Entity;
+} // namespace Firework
+
+namespace Firework::Internal
+{
+    /// @internal
+    /// @brief Internal API. Cached matches of a query, the entities that have every one of a list of component types, alongside pointers to those components.
+    /// Kept up to date as components are added and removed, so visiting the matches costs nothing per non-matching entity.
+    /// @note Removal swaps the last match into the hole, so matches are in no particular order.
+    class QueryCache final
+    {
+        std::vector<ComponentID> _ids;
+        std::vector<Entity*> denseEntities;
+        // `_ids.size()` components per match, in the order of `_ids`. Components are individually allocated, so these stay valid for as long as the match does.
+        std::vector<void*> denseComponents;
+        // Change tracking of the components, parallel to `denseComponents`.
+        std::vector<ComponentVersion*> denseVersions;
+        robin_hood::unordered_flat_map<Entity*, size_t> sparse;
+    public:
+        inline explicit QueryCache(std::vector<ComponentID> ids) : _ids(std::move(ids))
+        { }
+        QueryCache(const QueryCache&) = delete;
+        QueryCache(QueryCache&&) = delete;
+
+        QueryCache& operator=(const QueryCache&) = delete;
+        QueryCache& operator=(QueryCache&&) = delete;
+
+        /// @brief Retrieve the component types matched, in the order components are stored in.
+        inline std::span<const ComponentID> ids() const
+        {
+            return this->_ids;
+        }
+        /// @brief Retrieve the number of matches.
+        inline size_t size() const
+        {
+            return this->denseEntities.size();
+        }
+
+        /// @brief Retrieve the entity of a match.
+        inline Entity* entity(size_t index) const
+        {
+            return this->denseEntities[index];
+        }
+        /// @brief Retrieve the components of a match, parallel to `QueryCache::ids`. Invalidated by adding or removing matches.
+        inline void* const* components(size_t index) const
+        {
+            return this->denseComponents.data() + index * this->_ids.size();
+        }
+        /// @brief Retrieve the change tracking of the components of a match, parallel to `QueryCache::ids`. Invalidated by adding or removing matches.
+        inline ComponentVersion* const* versions(size_t index) const
+        {
+            return this->denseVersions.data() + index * this->_ids.size();
+        }
+
+        /// @brief Retrieve whether an entity is a match.
+        inline bool contains(Entity* entity) const
+        {
+            return this->sparse.contains(entity);
+        }
+        /// @brief Add a match.
+        /// @param entity Entity matched. Must not already be a match.
+        /// @param components Components of the entity, parallel to `QueryCache::ids`.
+        /// @param versions Change tracking of those components, parallel to `QueryCache::ids`.
+        inline void insert(Entity* entity, std::span<void* const> components, std::span<ComponentVersion* const> versions)
+        {
+            this->sparse.emplace(entity, this->denseEntities.size());
+            this->denseEntities.emplace_back(entity);
+            this->denseComponents.insert(this->denseComponents.end(), components.begin(), components.end());
+            this->denseVersions.insert(this->denseVersions.end(), versions.begin(), versions.end());
+        }
+        /// @brief Remove a match, if the entity is one.
+        /// @return Whether the entity was a match.
+        inline bool erase(Entity* entity)
+        {
+            auto it = this->sparse.find(entity);
+            if (it == this->sparse.end())
+                return false;
+
+            size_t index = it->second;
+            size_t last = this->denseEntities.size() - 1;
+            this->sparse.erase(it);
+            if (index != last)
+            {
+                this->denseEntities[index] = this->denseEntities[last];
+                std::copy_n(this->denseComponents.begin() + ptrdiff_t(last * this->_ids.size()), this->_ids.size(),
+                            this->denseComponents.begin() + ptrdiff_t(index * this->_ids.size()));
+                std::copy_n(this->denseVersions.begin() + ptrdiff_t(last * this->_ids.size()), this->_ids.size(),
+                            this->denseVersions.begin() + ptrdiff_t(index * this->_ids.size()));
+                this->sparse[this->denseEntities[index]] = index;
+            }
+            this->denseEntities.pop_back();
+            this->denseComponents.resize(this->denseComponents.size() - this->_ids.size());
+            this->denseVersions.resize(this->denseVersions.size() - this->_ids.size());
+            return true;
+        }
+        /// @brief Remove every match whose entity matches a predicate, in one pass. Keeps the order of the rest.
+        /// @param pred Predicate taking the entity.
+        inline void eraseIf(auto&& pred)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < this->denseEntities.size(); i++)
+            {
+                if (pred(this->denseEntities[i]))
+                {
+                    this->sparse.erase(this->denseEntities[i]);
+                    continue;
+                }
+
+                if (kept != i)
+                {
+                    this->denseEntities[kept] = this->denseEntities[i];
+                    std::copy_n(this->denseComponents.begin() + ptrdiff_t(i * this->_ids.size()), this->_ids.size(),
+                                this->denseComponents.begin() + ptrdiff_t(kept * this->_ids.size()));
+                    std::copy_n(this->denseVersions.begin() + ptrdiff_t(i * this->_ids.size()), this->_ids.size(),
+                                this->denseVersions.begin() + ptrdiff_t(kept * this->_ids.size()));
+                    this->sparse[this->denseEntities[kept]] = kept;
+                }
+                ++kept;
+            }
+            this->denseEntities.resize(kept);
+            this->denseComponents.resize(kept * this->_ids.size());
+            this->denseVersions.resize(kept * this->_ids.size());
+        }
+        /// @brief Remove every match.
+        inline void clear()
+        {
+            this->denseEntities.clear();
+            this->denseComponents.clear();
+            this->denseVersions.clear();
+            this->sparse.clear();
+        }
+    };
+} // namespace Firework::Internal
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Firework
+{
+    /// @brief Fixed-size set of the values of an enumeration, one bit each.
+    /// Bits are packed into 64-bit words, so combining masks works a word at a time, which compilers vectorize, and iterating skips straight between set bits.
+    /// @tparam Enum Enumeration with contiguous values from zero, up to a final `Count`.
+    template <typename Enum>
+    requires std::is_enum_v<Enum> && requires { Enum::Count; }
+    class EnumMask
+    {
+        constexpr static size_t Bits = size_t(Enum::Count);
+        constexpr static size_t WordBits = 64;
+        constexpr static size_t Words = (Bits + WordBits - 1) / WordBits;
+
+        std::array<uint64_t, Words> words {};
+    public:
+        constexpr EnumMask() noexcept = default;
+
+        /// @brief Retrieve whether a value is in the mask.
+        constexpr bool test(Enum value) const noexcept
+        {
+            return (this->words[size_t(value) / WordBits] >> (size_t(value) % WordBits)) & 1;
+        }
+        /// @brief Add a value to the mask.
+        constexpr void set(Enum value) noexcept
+        {
+            this->words[size_t(value) / WordBits] |= uint64_t(1) << (size_t(value) % WordBits);
+        }
+        /// @brief Remove a value from the mask.
+        constexpr void reset(Enum value) noexcept
+        {
+            this->words[size_t(value) / WordBits] &= ~(uint64_t(1) << (size_t(value) % WordBits));
+        }
+        /// @brief Remove every value from the mask.
+        constexpr void clear() noexcept
+        {
+            this->words.fill(0);
+        }
+
+        /// @brief Retrieve whether any value is in the mask.
+        constexpr bool any() const noexcept
+        {
+            uint64_t any = 0;
+            for (uint64_t word : this->words) any |= word;
+            return any != 0;
+        }
+        /// @brief Retrieve the number of values in the mask.
+        constexpr size_t count() const noexcept
+        {
+            size_t ret = 0;
+            for (uint64_t word : this->words) ret += size_t(std::popcount(word));
+            return ret;
+        }
+
+        /// @brief Call a function for every value in the mask, in ascending order.
+        /// @param func Function taking the value.
+        constexpr void forEach(auto&& func) const
+        {
+            for (size_t i = 0; i < Words; i++)
+            {
+                for (uint64_t word = this->words[i]; word; word &= word - 1) func(Enum(i * WordBits + size_t(std::countr_zero(word))));
+            }
+        }
+
+        constexpr EnumMask operator&(const EnumMask& other) const noexcept
+        {
+            EnumMask ret;
+            for (size_t i = 0; i < Words; i++) ret.words[i] = this->words[i] & other.words[i];
+            return ret;
+        }
+        constexpr EnumMask operator|(const EnumMask& other) const noexcept
+        {
+            EnumMask ret;
+            for (size_t i = 0; i < Words; i++) ret.words[i] = this->words[i] | other.words[i];
+            return ret;
+        }
+        /// @brief Retrieve the values in this mask, but not in another.
+        constexpr EnumMask without(const EnumMask& other) const noexcept
+        {
+            EnumMask ret;
+            for (size_t i = 0; i < Words; i++) ret.words[i] = this->words[i] & ~other.words[i];
+            return ret;
+        }
+
+        constexpr bool operator==(const EnumMask&) const noexcept = default;
+    };
+} // namespace Firework
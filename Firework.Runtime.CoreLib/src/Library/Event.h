@@ -1,21 +1,272 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <function.h>
-#include <list>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace Firework
 {
-    /// @brief Iterator alias for a subscribed event handler.
-    /// @tparam ...Args Arguments passed by the event when it is raised.
+    namespace Internal
+    {
+        template <typename Handler>
+        class EventHandlerList;
+    } // namespace Internal
+
     template <typename... Args>
-    using EventHandler = typename std::list<func::function<void(Args...)>>::const_iterator;
+    class ConcurrentFuncPtrEvent;
+
+    /// @brief Handle to a subscribed event handler, used to unsubscribe it.
+    /// Handles are checked against the generation of the handler they were returned for, so a handle kept past its handler being unsubscribed never unsubscribes a
+    /// handler subscribed after it.
+    class EventHandle final
+    {
+        uint32_t slot = ~0u;
+        uint32_t generation = 0;
+
+        constexpr EventHandle(uint32_t slot, uint32_t generation) : slot(slot), generation(generation)
+        { }
+    public:
+        /// @brief Construct a handle to no event handler.
+        constexpr EventHandle() = default;
+
+        /// @brief Retrieve whether this handle was returned for an event handler. Says nothing of whether that handler is still subscribed.
+        constexpr explicit operator bool() const noexcept
+        {
+            return this->slot != ~0u;
+        }
+
+        template <typename>
+        friend class Firework::Internal::EventHandlerList;
+        template <typename...>
+        friend class Firework::ConcurrentFuncPtrEvent;
+    };
+
+    namespace Internal
+    {
+        /// @internal
+        /// @brief Internal API. Storage of the handlers of an event.
+        /// Handlers are packed contiguously in subscription order, so raising is a linear walk. Unsubscribing marks a handler dead rather than shifting the rest, and
+        /// dead handlers are compacted away once they make up half the storage. Handles find their handler through a slot table, so unsubscribing is O(1).
+        /// While the event is being raised, nothing is moved or destroyed: handlers subscribed meanwhile wait in `pending` until the outermost raise finishes, and
+        /// handlers unsubscribed meanwhile, the one running included, are only marked dead.
+        template <typename Handler>
+        class EventHandlerList final
+        {
+            constexpr static uint32_t DeadSlot = ~0u;
+
+            struct Entry
+            {
+                Handler handler;
+                // Slot of the handle to this handler, `DeadSlot` once unsubscribed.
+                uint32_t slot;
+            };
+            struct Slot
+            {
+                uint32_t generation = 0;
+                // Position of the handler in `entries`, or, past its end, in `pending`.
+                uint32_t position = 0;
+            };
+
+            std::vector<Entry> entries;
+            std::vector<Entry> pending;
+            std::vector<Slot> slots;
+            std::vector<uint32_t> freeSlots;
+            size_t live = 0;
+            size_t dead = 0;
+            uint32_t raising = 0;
+            // Whether anything was subscribed or unsubscribed during the current raise.
+            bool deferred = false;
+
+            inline Entry& entryAt(uint32_t position)
+            {
+                return position < this->entries.size() ? this->entries[position] : this->pending[position - this->entries.size()];
+            }
+            inline void kill(Entry& entry)
+            {
+                Slot& slot = this->slots[entry.slot];
+                ++slot.generation;
+                this->freeSlots.emplace_back(entry.slot);
+                entry.slot = DeadSlot;
+                --this->live;
+                ++this->dead;
+
+                // The handler may be the one running, so it's only released once the raise finishes.
+                if (this->raising)
+                    this->deferred = true;
+                else
+                    entry.handler = Handler();
+            }
+            inline void compactIfSparse()
+            {
+                if (this->dead * 2 <= this->entries.size())
+                    return;
+
+                size_t kept = 0;
+                for (size_t i = 0; i < this->entries.size(); i++)
+                {
+                    if (this->entries[i].slot == DeadSlot)
+                        continue;
+
+                    if (kept != i)
+                        this->entries[kept] = std::move(this->entries[i]);
+                    this->slots[this->entries[kept].slot].position = uint32_t(kept);
+                    ++kept;
+                }
+                this->entries.erase(this->entries.begin() + ptrdiff_t(kept), this->entries.end());
+                this->dead = 0;
+            }
+            inline void settle()
+            {
+                if (!this->deferred)
+                    return;
+                this->deferred = false;
+
+                // Pending handlers were given positions past the end of `entries` in order, so appending them keeps their slots correct.
+                for (Entry& entry : this->pending) this->entries.emplace_back(std::move(entry));
+                this->pending.clear();
+
+                for (Entry& entry : this->entries)
+                {
+                    if (entry.slot == DeadSlot)
+                        entry.handler = Handler();
+                }
+                this->compactIfSparse();
+            }
+        public:
+            EventHandlerList() = default;
+            EventHandlerList(const EventHandlerList&) = delete;
+            EventHandlerList(EventHandlerList&&) = delete;
+
+            EventHandlerList& operator=(const EventHandlerList&) = delete;
+            EventHandlerList& operator=(EventHandlerList&&) = delete;
+
+            /// @brief Retrieve whether there are no subscribed handlers, counting ones still pending.
+            inline bool empty() const noexcept
+            {
+                return this->live == 0;
+            }
+
+            /// @brief Subscribe a handler. Deferred until the outermost raise finishes if the event is being raised.
+            inline EventHandle add(Handler handler)
+            {
+                uint32_t slot;
+                if (!this->freeSlots.empty())
+                {
+                    slot = this->freeSlots.back();
+                    this->freeSlots.pop_back();
+                }
+                else
+                {
+                    slot = uint32_t(this->slots.size());
+                    this->slots.emplace_back();
+                }
+
+                this->slots[slot].position = uint32_t(this->entries.size() + this->pending.size());
+                if (this->raising)
+                {
+                    this->pending.emplace_back(Entry { .handler = std::move(handler), .slot = slot });
+                    this->deferred = true;
+                }
+                else
+                    this->entries.emplace_back(Entry { .handler = std::move(handler), .slot = slot });
+                ++this->live;
+                return EventHandle(slot, this->slots[slot].generation);
+            }
+            /// @brief Unsubscribe the handler a handle was returned for, if it's still subscribed.
+            inline bool remove(EventHandle handle)
+            {
+                if (handle.slot >= this->slots.size() || this->slots[handle.slot].generation != handle.generation)
+                    return false;
+
+                this->kill(this->entryAt(this->slots[handle.slot].position));
+                if (!this->raising)
+                    this->compactIfSparse();
+                return true;
+            }
+            /// @brief Unsubscribe the first handler matching a predicate, if any.
+            inline bool removeIf(auto&& pred)
+            {
+                for (std::vector<Entry>* list : { &this->entries, &this->pending })
+                {
+                    for (Entry& entry : *list)
+                    {
+                        if (entry.slot != DeadSlot && pred(entry.handler))
+                        {
+                            this->kill(entry);
+                            if (!this->raising)
+                                this->compactIfSparse();
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+            /// @brief Unsubscribe every handler.
+            inline void clear()
+            {
+                for (std::vector<Entry>* list : { &this->entries, &this->pending })
+                {
+                    for (Entry& entry : *list)
+                    {
+                        if (entry.slot != DeadSlot)
+                            this->kill(entry);
+                    }
+                }
+                if (!this->raising)
+                    this->compactIfSparse();
+            }
+
+            /// @brief Call every subscribed handler, in subscription order. Handlers subscribed during the raise aren't called by it.
+            template <typename... Args>
+            inline void raise(Args&&... args)
+            {
+                struct RaiseScope
+                {
+                    EventHandlerList& list;
+                    inline explicit RaiseScope(EventHandlerList& list) : list(list)
+                    {
+                        ++list.raising;
+                    }
+                    inline ~RaiseScope()
+                    {
+                        if (--this->list.raising == 0)
+                            this->list.settle();
+                    }
+                } scope(*this);
+
+                // Nothing is added to or removed from `entries` until the outermost raise finishes, so iterating it directly is safe.
+                for (Entry& entry : this->entries)
+                {
+                    if (entry.slot != DeadSlot)
+                        entry.handler(args...);
+                }
+            }
+            /// @brief Call every subscribed handler, in subscription order, without deferring modification. May run on several threads at once, as long as nothing
+            /// subscribes or unsubscribes meanwhile.
+            template <typename... Args>
+            inline void raiseConcurrently(Args&&... args) const
+            {
+                for (const Entry& entry : this->entries)
+                {
+                    if (entry.slot != DeadSlot)
+                        entry.handler(args...);
+                }
+            }
+        };
+    } // namespace Internal
 
     /// @brief Event capable of having any type of functor subscribed to it.
+    /// Handlers may subscribe and unsubscribe handlers, themselves included, while the event is being raised. Such changes take effect once the outermost raise
+    /// finishes, so a raise calls exactly the handlers subscribed when it started, minus any unsubscribed before their turn.
     /// @tparam ...Args Arguments passed by the event when it is raised.
     template <typename... Args>
     class Event
     {
-        std::list<func::function<void(Args...)>> children;
+        Internal::EventHandlerList<func::function<void(Args...)>> handlers;
     public:
         inline Event()
         { }
@@ -24,37 +275,30 @@ namespace Firework
 
         /// @brief Subscribe a event handler to this event.
         /// @param func Event handler to subscribe.
-        /// @return Iterator to the event handler, used to unsubscribe.
+        /// @return Handle to the event handler, used to unsubscribe.
         /// @note Not thread-safe.
-        inline EventHandler<Args...> operator+=(func::function<void(Args...)>&& func)
+        inline EventHandle operator+=(func::function<void(Args...)>&& func)
         {
-            return this->children.emplace_back(std::forward(func));
+            return this->handlers.add(std::move(func));
         }
         /// @brief Unsubscribe a event handler from this event.
         /// @param func Event handler to unsubscribe.
         /// @return Whether the event handler was unsubscribed.
         /// @retval - ```true```: The event handler was unsubscribed.
         /// @retval - ```false```: The event handler was not subscribed to this event.
-        /// @warning This function runs in O(n) time, for n number of event handlers.
+        /// @warning This function runs in O(n) time, for n number of event handlers. Prefer unsubscribing by handle.
         /// @note Not thread-safe.
         inline bool operator-=(const func::function<void(Args...)>& func)
         {
-            for (auto it = this->children.begin(); it != this->children.end(); ++it)
-            {
-                if (*it == func)
-                {
-                    this->children.erase(it);
-                    return true;
-                }
-            }
-            return false;
+            return this->handlers.removeIf([&](const func::function<void(Args...)>& handler) { return handler == func; });
         }
         /// @brief Unsubscribe an event handler from this event.
-        /// @param it Iterator to event handler, returned by ```Firework::Event<...>::operator+=```.
+        /// @param handle Handle to the event handler, returned by ```Firework::Event<...>::operator+=```.
+        /// @return Whether the event handler was unsubscribed. ```false``` if it already was.
         /// @note Not thread-safe.
-        inline void operator-=(EventHandler<Args...> it)
+        inline bool operator-=(EventHandle handle)
         {
-            this->children.erase(it);
+            return this->handlers.remove(handle);
         }
 
         /// @brief Raise this event.
@@ -62,7 +306,14 @@ namespace Firework
         /// @note Not thread-safe.
         inline void operator()(Args... args)
         {
-            for (auto it = this->children.begin(); it != this->children.end(); ++it) (*it)(args...);
+            this->handlers.raise(args...);
+        }
+        /// @brief Raise this event from any number of threads at once.
+        /// @param ...args Arguments to pass to subscribed event handlers.
+        /// @warning Nothing may subscribe to or unsubscribe from this event while it's being raised this way, handlers included.
+        inline void raiseConcurrently(Args... args) const
+        {
+            this->handlers.raiseConcurrently(args...);
         }
 
         /// @brief Retrieve whether this event is handled.
@@ -70,56 +321,237 @@ namespace Firework
         /// @retval - ```true```: This event has no subscribed event handlers.
         /// @retval - ```false```: This event has at least one subscribed event handler.
         /// @note Not thread-safe.
-        inline bool unhandled()
+        inline bool unhandled() const
         {
-            return this->children.empty();
+            return this->handlers.empty();
         }
         /// @brief Remove all subscribed event handlers from this event.
         /// @note Not thread-safe.
         inline void clear()
         {
-            this->children.clear();
+            this->handlers.clear();
         }
     };
 
+    /// @brief Event capable of having function pointers subscribed to it. Cheaper to raise than `Event`, and modifiable while raised in the same way.
+    /// @tparam ...Args Arguments passed by the event when it is raised.
     template <typename... Args>
     class FuncPtrEvent
     {
-        std::list<void (*)(Args...)> children;
+        Internal::EventHandlerList<void (*)(Args...)> handlers;
     public:
         inline FuncPtrEvent()
         { }
         FuncPtrEvent(const FuncPtrEvent<Args...>&) = delete;
         FuncPtrEvent(FuncPtrEvent<Args...>&&) = delete;
 
-        inline void operator+=(void (*func)(Args...))
+        /// @brief Subscribe a event handler to this event.
+        /// @param func Event handler to subscribe.
+        /// @return Handle to the event handler, used to unsubscribe.
+        /// @note Not thread-safe.
+        inline EventHandle operator+=(void (*func)(Args...))
         {
-            this->children.emplace_back(func);
+            return this->handlers.add(func);
         }
+        /// @brief Unsubscribe the first subscription of a function from this event.
+        /// @param func Event handler to unsubscribe.
+        /// @return Whether the event handler was unsubscribed.
+        /// @warning This function runs in O(n) time, for n number of event handlers. Prefer unsubscribing by handle.
+        /// @note Not thread-safe.
         inline bool operator-=(void (*func)(Args...))
         {
-            for (auto it = this->children.begin(); it != this->children.end(); ++it)
+            return this->handlers.removeIf([&](void (*handler)(Args...)) { return handler == func; });
+        }
+        /// @brief Unsubscribe an event handler from this event.
+        /// @param handle Handle to the event handler, returned by ```Firework::FuncPtrEvent<...>::operator+=```.
+        /// @return Whether the event handler was unsubscribed. ```false``` if it already was.
+        /// @note Not thread-safe.
+        inline bool operator-=(EventHandle handle)
+        {
+            return this->handlers.remove(handle);
+        }
+
+        /// @brief Raise this event.
+        /// @param ...args Arguments to pass to subscribed event handlers.
+        /// @note Not thread-safe.
+        inline void operator()(Args... args)
+        {
+            this->handlers.raise(args...);
+        }
+        /// @brief Raise this event from any number of threads at once.
+        /// @param ...args Arguments to pass to subscribed event handlers.
+        /// @warning Nothing may subscribe to or unsubscribe from this event while it's being raised this way, handlers included.
+        inline void raiseConcurrently(Args... args) const
+        {
+            this->handlers.raiseConcurrently(args...);
+        }
+
+        /// @brief Retrieve whether this event is handled.
+        /// @note Not thread-safe.
+        inline bool unhandled() const
+        {
+            return this->handlers.empty();
+        }
+        /// @brief Remove all subscribed event handlers from this event.
+        /// @note Not thread-safe.
+        inline void clear()
+        {
+            this->handlers.clear();
+        }
+    };
+
+    /// @brief Event capable of having function pointers subscribed to it, from any thread, while it's being raised on any number of others.
+    /// Raising reads an immutable snapshot of the handlers, and is wait-free. Subscribing and unsubscribing publish a new snapshot under a lock, so they're
+    /// slower than on `FuncPtrEvent`. A snapshot replaced while being raised is released by a later modification, once nothing is raising the event.
+    /// A raise calls the handlers in the snapshot it started with. Handlers may subscribe and unsubscribe, themselves included, which takes effect from the next
+    /// raise.
+    /// @tparam ...Args Arguments passed by the event when it is raised.
+    template <typename... Args>
+    class ConcurrentFuncPtrEvent
+    {
+        struct Subscriber
+        {
+            void (*handler)(Args...);
+            EventHandle handle;
+        };
+        struct Snapshot
+        {
+            std::vector<Subscriber> subscribers;
+        };
+
+        std::atomic<const Snapshot*> current = nullptr;
+        // Raises in progress. Observing none after a snapshot is replaced proves nothing still reads it.
+        mutable std::atomic<size_t> raising = 0;
+        std::atomic<size_t> count = 0;
+
+        std::mutex modifyLock;
+        std::vector<const Snapshot*> retired;
+        uint64_t nextHandle = 0;
+
+        template <typename Modify>
+        inline auto modify(Modify&& modify)
+        {
+            std::lock_guard guard(this->modifyLock);
+
+            const Snapshot* previous = this->current.load(std::memory_order_relaxed);
+            std::vector<Subscriber> subscribers = previous ? previous->subscribers : std::vector<Subscriber>();
+            auto ret = modify(subscribers);
+            if (previous && subscribers.size() == previous->subscribers.size())
+                return ret;
+
+            this->count.store(subscribers.size(), std::memory_order_relaxed);
+            this->current.store(subscribers.empty() ? nullptr : new Snapshot { .subscribers = std::move(subscribers) }, std::memory_order_seq_cst);
+            if (previous)
+                this->retired.emplace_back(previous);
+            if (this->raising.load(std::memory_order_seq_cst) == 0)
+            {
+                for (const Snapshot* snapshot : this->retired) delete snapshot;
+                this->retired.clear();
+            }
+            return ret;
+        }
+    public:
+        constexpr ConcurrentFuncPtrEvent() = default;
+        ConcurrentFuncPtrEvent(const ConcurrentFuncPtrEvent<Args...>&) = delete;
+        ConcurrentFuncPtrEvent(ConcurrentFuncPtrEvent<Args...>&&) = delete;
+        inline ~ConcurrentFuncPtrEvent()
+        {
+            delete this->current.load(std::memory_order_relaxed);
+            for (const Snapshot* snapshot : this->retired) delete snapshot;
+        }
+
+        /// @brief Subscribe a event handler to this event.
+        /// @param func Event handler to subscribe.
+        /// @return Handle to the event handler, used to unsubscribe.
+        /// @note Thread-safe.
+        inline EventHandle operator+=(void (*func)(Args...))
+        {
+            return this->modify([&](std::vector<Subscriber>& subscribers)
+            {
+                EventHandle handle(uint32_t(this->nextHandle), uint32_t(this->nextHandle >> 32));
+                ++this->nextHandle;
+                subscribers.emplace_back(Subscriber { .handler = func, .handle = handle });
+                return handle;
+            });
+        }
+        /// @brief Unsubscribe the first subscription of a function from this event.
+        /// @param func Event handler to unsubscribe.
+        /// @return Whether the event handler was unsubscribed.
+        /// @note Thread-safe.
+        inline bool operator-=(void (*func)(Args...))
+        {
+            return this->modify([&](std::vector<Subscriber>& subscribers)
             {
-                if (*it == func)
+                for (auto it = subscribers.begin(); it != subscribers.end(); ++it)
                 {
-                    this->children.erase(it);
-                    return true;
+                    if (it->handler == func)
+                    {
+                        subscribers.erase(it);
+                        return true;
+                    }
                 }
-            }
-            return false;
+                return false;
+            });
         }
-        inline void operator()(Args... args)
+        /// @brief Unsubscribe an event handler from this event.
+        /// @param handle Handle to the event handler, returned by ```Firework::ConcurrentFuncPtrEvent<...>::operator+=```.
+        /// @return Whether the event handler was unsubscribed. ```false``` if it already was.
+        /// @note Thread-safe.
+        inline bool operator-=(EventHandle handle)
+        {
+            return this->modify([&](std::vector<Subscriber>& subscribers)
+            {
+                for (auto it = subscribers.begin(); it != subscribers.end(); ++it)
+                {
+                    if (it->handle.slot == handle.slot && it->handle.generation == handle.generation)
+                    {
+                        subscribers.erase(it);
+                        return true;
+                    }
+                }
+                return false;
+            });
+        }
+
+        /// @brief Raise this event.
+        /// @param ...args Arguments to pass to subscribed event handlers.
+        /// @note Thread-safe, and wait-free, aside from the handlers themselves.
+        inline void operator()(Args... args) const
         {
-            for (auto it = this->children.begin(); it != this->children.end(); ++it) (*it)(args...);
+            struct RaiseScope
+            {
+                std::atomic<size_t>& raising;
+                inline explicit RaiseScope(std::atomic<size_t>& raising) : raising(raising)
+                {
+                    this->raising.fetch_add(1, std::memory_order_seq_cst);
+                }
+                inline ~RaiseScope()
+                {
+                    this->raising.fetch_sub(1, std::memory_order_release);
+                }
+            } scope(this->raising);
+
+            const Snapshot* snapshot = this->current.load(std::memory_order_seq_cst);
+            if (!snapshot)
+                return;
+            for (const Subscriber& subscriber : snapshot->subscribers) subscriber.handler(args...);
         }
 
-        inline bool unhandled()
+        /// @brief Retrieve whether this event is handled.
+        /// @note Thread-safe.
+        inline bool unhandled() const
         {
-            return this->children.empty();
+            return this->count.load(std::memory_order_relaxed) == 0;
         }
+        /// @brief Remove all subscribed event handlers from this event.
+        /// @note Thread-safe.
         inline void clear()
         {
-            this->children.clear();
+            this->modify([](std::vector<Subscriber>& subscribers)
+            {
+                subscribers.clear();
+                return true;
+            });
         }
     };
-} // namespace Firework
\ No newline at end of file
+} // namespace Firework
@@ -1,155 +1,265 @@
 #pragma once
 
-#include <function.h>
+#include <cstddef>
+#include <functional>
 #include <module/sys>
 #include <type_traits>
+#include <utility>
 
 namespace Firework
 {
-    template <typename GetterReturnType, typename SetterInputType>
+    namespace Internal
+    {
+        /// @internal
+        /// @brief Internal API. Read a property through its getter, a pointer to a data member, member function, static variable or function.
+        template <typename Getter>
+        inline decltype(auto) propertyGet(Getter getter, [[maybe_unused]] auto* owner)
+        {
+            if constexpr (std::is_null_pointer_v<Getter>)
+                return;
+            else if constexpr (std::is_member_pointer_v<Getter>)
+                return std::invoke(getter, *owner);
+            else if constexpr (std::is_function_v<std::remove_pointer_t<Getter>>)
+                return getter();
+            else
+                return (*getter);
+        }
+        /// @internal
+        /// @brief Internal API. Write a property through its setter, a pointer to a data member, member function, static variable or function.
+        template <typename Setter, typename Value>
+        inline void propertySet(Setter setter, [[maybe_unused]] auto* owner, Value&& value)
+        {
+            if constexpr (std::is_member_function_pointer_v<Setter>)
+                std::invoke(setter, *owner, std::forward<Value>(value));
+            else if constexpr (std::is_member_object_pointer_v<Setter>)
+                (*owner).*setter = std::forward<Value>(value);
+            else if constexpr (std::is_function_v<std::remove_pointer_t<Setter>>)
+                setter(std::forward<Value>(value));
+            else
+                *setter = std::forward<Value>(value);
+        }
+    } // namespace Internal
+
+    /// @brief Member that reads and writes like a value, through a getter and a setter.
+    /// Properties store nothing, and are bound to their getter and setter by type, so reading or writing one is a direct, inlinable call. Declare them with
+    /// `_fw_property`, or `_fw_static_property` for static members.
+    /// @tparam GetterReturnType Type reading the property yields.
+    /// @tparam SetterInputType Type writing the property takes.
+    /// @tparam Accessor Type with static functions `get` and `set`, taking the address of the property. Generated by the declaring macros.
+    template <typename GetterReturnType, typename SetterInputType, typename Accessor>
     struct Property
     {
-        inline explicit Property(auto&& getter, auto&& setter) :
-            getter(std::forward<typename std::remove_cvref<decltype(getter)>::type>(getter)), setter(std::forward<typename std::remove_cvref<decltype(setter)>::type>(setter))
-        { }
-        inline explicit Property(const Property<GetterReturnType, SetterInputType>& other) = delete;
-        inline explicit Property(Property<GetterReturnType, SetterInputType>&& other) = delete;
+        constexpr Property() = default;
+        inline explicit Property(const Property&) = delete;
+        inline explicit Property(Property&&) = delete;
 
         inline GetterReturnType operator=(SetterInputType value) const
         {
-            this->setter(value);
-            return this->getter();
+            this->set(std::forward<SetterInputType>(value));
+            return this->get();
         }
-        inline GetterReturnType operator=(const Property<GetterReturnType, SetterInputType>& rhs) = delete;
-        inline GetterReturnType operator=(Property<GetterReturnType, SetterInputType>&&) = delete;
+        inline GetterReturnType operator=(const Property&) = delete;
+        inline GetterReturnType operator=(Property&&) = delete;
 
 #pragma region Arithmetic
         inline auto operator+(auto rhs) const -> decltype(std::declval<GetterReturnType>() + rhs)
         requires requires(GetterReturnType _lhs, decltype(rhs) _rhs) { _lhs + _rhs; }
         {
-            return (this->getter() + rhs);
+            return (this->get() + rhs);
         }
         inline GetterReturnType operator-(SetterInputType rhs) const
         {
-            return (this->getter() - rhs);
+            return (this->get() - rhs);
         }
         inline GetterReturnType operator*(SetterInputType rhs) const
         {
-            return (this->getter() * rhs);
+            return (this->get() * rhs);
         }
         inline GetterReturnType operator/(SetterInputType rhs) const
         {
-            return (this->getter() / rhs);
+            return (this->get() / rhs);
         }
         inline GetterReturnType operator%(SetterInputType rhs) const
         {
-            return (this->getter() % rhs);
+            return (this->get() % rhs);
         }
 
         inline GetterReturnType operator++() const
         {
-            GetterReturnType type = this->getter();
+            std::remove_cvref_t<GetterReturnType> type = this->get();
             ++type;
-            this->setter(type);
-            return type;
+            this->set(type);
+            return this->get();
         }
         inline GetterReturnType operator--() const
         {
-            GetterReturnType type = this->getter();
+            std::remove_cvref_t<GetterReturnType> type = this->get();
             --type;
-            this->setter(type);
-            return type;
+            this->set(type);
+            return this->get();
         }
 #pragma endregion
 
 #pragma region Assignment
         inline GetterReturnType operator+=(SetterInputType rhs) const
         {
-            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->getter());
+            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->get());
             type += rhs;
-            this->setter(type);
-            return this->getter();
+            this->set(std::move(type));
+            return this->get();
         }
         inline GetterReturnType operator-=(SetterInputType rhs) const
         {
-            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->getter());
+            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->get());
             type -= rhs;
-            this->setter(type);
-            return this->getter();
+            this->set(std::move(type));
+            return this->get();
         }
         inline GetterReturnType operator*=(SetterInputType rhs) const
         {
-            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->getter());
+            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->get());
             type *= rhs;
-            this->setter(type);
-            return this->getter();
+            this->set(std::move(type));
+            return this->get();
         }
         inline GetterReturnType operator/=(SetterInputType rhs) const
         {
-            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->getter());
+            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->get());
             type /= rhs;
-            this->setter(type);
-            return this->getter();
+            this->set(std::move(type));
+            return this->get();
         }
         inline GetterReturnType operator%=(SetterInputType rhs) const
         {
-            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->getter());
+            std::remove_cvref_t<SetterInputType> type = _as(std::remove_cvref_t<SetterInputType>, this->get());
             type %= rhs;
-            this->setter(type);
-            return this->getter();
+            this->set(std::move(type));
+            return this->get();
         }
 #pragma endregion
 
 #pragma region Comparison
-        inline GetterReturnType operator==(SetterInputType rhs) const
+        inline bool operator==(SetterInputType rhs) const
         {
-            return this->getter() == rhs;
+            return this->get() == rhs;
         }
-        inline GetterReturnType operator!=(SetterInputType rhs) const
+        inline bool operator!=(SetterInputType rhs) const
         {
-            return this->getter() != rhs;
+            return this->get() != rhs;
         }
-        inline GetterReturnType operator>=(SetterInputType rhs) const
+        inline bool operator>=(SetterInputType rhs) const
         {
-            return this->getter() >= rhs;
+            return this->get() >= rhs;
         }
-        inline GetterReturnType operator<=(SetterInputType rhs) const
+        inline bool operator<=(SetterInputType rhs) const
         {
-            return this->getter() <= rhs;
+            return this->get() <= rhs;
         }
-        inline GetterReturnType operator>(SetterInputType rhs) const
+        inline bool operator>(SetterInputType rhs) const
         {
-            return this->getter() > rhs;
+            return this->get() > rhs;
         }
-        inline GetterReturnType operator<(SetterInputType rhs) const
+        inline bool operator<(SetterInputType rhs) const
         {
-            return this->getter() < rhs;
+            return this->get() < rhs;
         }
 #pragma endregion
 
         inline GetterReturnType operator()() const
         {
-            return this->getter();
+            return this->get();
         }
         inline operator GetterReturnType() const
         {
-            return this->getter();
+            return this->get();
         }
     private:
-        [[no_unique_address]] const func::function<GetterReturnType()> getter;
-        [[no_unique_address]] const func::function<void(SetterInputType)> setter;
+        inline GetterReturnType get() const
+        {
+            return Accessor::get(this);
+        }
+        inline void set(SetterInputType value) const
+        {
+            Accessor::set(this, std::forward<SetterInputType>(value));
+        }
     };
-    template <typename SetterInputType>
-    struct Property<void, SetterInputType>
+    /// @brief Property that is only written. See `Property`.
+    template <typename SetterInputType, typename Accessor>
+    struct Property<void, SetterInputType, Accessor>
     {
-        constexpr Property(auto&& setter) : setter(std::forward<typename std::remove_cvref<decltype(setter)>::type>(setter))
-        { }
+        constexpr Property() = default;
+        inline explicit Property(const Property&) = delete;
+        inline explicit Property(Property&&) = delete;
 
-        constexpr void operator=(SetterInputType other) const
+        inline void operator=(SetterInputType value) const
         {
-            return this->setter(other);
+            Accessor::set(this, std::forward<SetterInputType>(value));
         }
-    private:
-        [[no_unique_address]] const func::function<void(SetterInputType)> setter;
+        inline void operator=(const Property&) = delete;
+        inline void operator=(Property&&) = delete;
     };
 } // namespace Firework
+
+/// @brief Let a member of empty type share its address with other members. MSVC, and Clang targeting its ABI, ignore the standard attribute, and only honour their own.
+#if _MSC_VER
+#define _fw_no_unique_address [[msvc::no_unique_address]]
+#else
+#define _fw_no_unique_address [[no_unique_address]]
+#endif
+
+#if __GNUC__ || __clang__
+#define _fw_property_push_nowarn_offsetof() _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define _fw_property_pop_nowarn_offsetof() _Pragma("GCC diagnostic pop")
+#else
+#define _fw_property_push_nowarn_offsetof()
+#define _fw_property_pop_nowarn_offsetof()
+#endif
+
+/// @brief Declare a member property, which finds the object it belongs to from its own address, so it occupies no storage.
+/// @param Owner Class declaring the property.
+/// @param name Name of the property.
+/// @param GetterReturnType Type reading the property yields, `void` for a property that is only written.
+/// @param SetterInputType Type writing the property takes.
+/// @param getter Pointer to the data member read, or the member function called, to read the property. `nullptr` for a property that is only written.
+/// @param setter Pointer to the data member assigned, or the member function called, to write the property.
+/// @note Offsets into classes that aren't standard-layout are only conditionally supported, but are by every compiler the runtime builds with, for classes without
+/// virtual bases.
+#define _fw_property(Owner, name, GetterReturnType, SetterInputType, getter, setter)                                                                              \
+    struct _fwPropertyAccessor_##name                                                                                                                            \
+    {                                                                                                                                                            \
+        inline static Owner* owner(const void* property) noexcept                                                                                               \
+        {                                                                                                                                                        \
+            _fw_property_push_nowarn_offsetof();                                                                                                                 \
+            const size_t offset = offsetof(Owner, name);                                                                                                         \
+            _fw_property_pop_nowarn_offsetof();                                                                                                                  \
+            return reinterpret_cast<Owner*>(const_cast<char*>(static_cast<const char*>(property)) - offset);                                                   \
+        }                                                                                                                                                        \
+        inline static GetterReturnType get(const void* property)                                                                                                \
+        {                                                                                                                                                        \
+            return ::Firework::Internal::propertyGet(getter, _fwPropertyAccessor_##name::owner(property));                                                      \
+        }                                                                                                                                                        \
+        inline static void set(const void* property, SetterInputType value)                                                                                     \
+        {                                                                                                                                                        \
+            ::Firework::Internal::propertySet(setter, _fwPropertyAccessor_##name::owner(property), std::forward<SetterInputType>(value));                       \
+        }                                                                                                                                                        \
+    };                                                                                                                                                           \
+    _fw_no_unique_address const ::Firework::Property<GetterReturnType, SetterInputType, _fwPropertyAccessor_##name> name {}
+/// @brief Declare a static property.
+/// @param name Name of the property.
+/// @param GetterReturnType Type reading the property yields, `void` for a property that is only written.
+/// @param SetterInputType Type writing the property takes.
+/// @param getter Pointer to the static variable read, or the function called, to read the property. `nullptr` for a property that is only written.
+/// @param setter Pointer to the static variable assigned, or the function called, to write the property.
+#define _fw_static_property(name, GetterReturnType, SetterInputType, getter, setter)                                                                              \
+    struct _fwPropertyAccessor_##name                                                                                                                            \
+    {                                                                                                                                                            \
+        inline static GetterReturnType get(const void*)                                                                                                         \
+        {                                                                                                                                                        \
+            return ::Firework::Internal::propertyGet(getter, static_cast<void*>(nullptr));                                                                       \
+        }                                                                                                                                                        \
+        inline static void set(const void*, SetterInputType value)                                                                                              \
+        {                                                                                                                                                        \
+            ::Firework::Internal::propertySet(setter, static_cast<void*>(nullptr), std::forward<SetterInputType>(value));                                        \
+        }                                                                                                                                                        \
+    };                                                                                                                                                           \
+    inline static const ::Firework::Property<GetterReturnType, SetterInputType, _fwPropertyAccessor_##name> name {}
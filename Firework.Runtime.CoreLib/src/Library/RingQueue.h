@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Firework
+{
+    /// @brief Bounded, lock-free, multi-producer multi-consumer FIFO ring buffer.
+    /// @tparam T Element type. Must be nothrow move-constructible.
+    /// @tparam Capacity Maximum number of elements in flight. Must be a power of two.
+    /// @note Unlike `moodycamel::ConcurrentQueue`, elements are dequeued in the global order they were enqueued in, regardless of the producing thread.
+    template <typename T, size_t Capacity>
+    requires std::is_nothrow_move_constructible_v<T>
+    class RingQueue
+    {
+        static_assert(Capacity >= 2 && std::has_single_bit(Capacity), "Capacity must be a power of two.");
+
+        constexpr static size_t CacheLineSize = 64;
+
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        alignas(CacheLineSize) std::atomic<size_t> enqueuePosition = 0;
+        alignas(CacheLineSize) std::atomic<size_t> dequeuePosition = 0;
+    public:
+        inline RingQueue() : cells(new Cell[Capacity])
+        {
+            for (size_t i = 0; i < Capacity; i++) this->cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        RingQueue(const RingQueue&) = delete;
+        RingQueue(RingQueue&&) = delete;
+        inline ~RingQueue()
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                T discard;
+                while (this->tryDequeue(discard));
+            }
+        }
+
+        RingQueue& operator=(const RingQueue&) = delete;
+        RingQueue& operator=(RingQueue&&) = delete;
+
+        /// @brief Attempt to enqueue an element.
+        /// @param ...args Arguments to construct the element from.
+        /// @return Whether the element was enqueued.
+        /// @retval - ```true```: The element was enqueued.
+        /// @retval - ```false```: The queue is full, nothing was constructed.
+        /// @note Thread-safe. Lock-free.
+        template <typename... Args>
+        inline bool tryEmplace(Args&&... args)
+        {
+            size_t pos = this->enqueuePosition.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true)
+            {
+                cell = &this->cells[pos & (Capacity - 1)];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos);
+                if (diff == 0)
+                {
+                    if (this->enqueuePosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+
+            new(cell->storage) T(std::forward<Args>(args)...);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+        /// @brief Enqueue an element, yielding while the queue is full.
+        /// @param ...args Arguments to construct the element from.
+        /// @note Thread-safe. Lock-free unless the queue is full.
+        template <typename... Args>
+        inline void emplace(Args&&... args)
+        {
+            while (!this->tryEmplace(std::forward<Args>(args)...)) std::this_thread::yield();
+        }
+
+        /// @brief Attempt to dequeue the oldest element.
+        /// @param out Element to move the dequeued value into.
+        /// @return Whether an element was dequeued.
+        /// @note Thread-safe. Lock-free.
+        inline bool tryDequeue(T& out)
+        {
+            size_t pos = this->dequeuePosition.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true)
+            {
+                cell = &this->cells[pos & (Capacity - 1)];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                ptrdiff_t diff = ptrdiff_t(seq) - ptrdiff_t(pos + 1);
+                if (diff == 0)
+                {
+                    if (this->dequeuePosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = this->dequeuePosition.load(std::memory_order_relaxed);
+            }
+
+            T* value = std::launder(reinterpret_cast<T*>(cell->storage));
+            out = std::move(*value);
+            value->~T();
+            cell->sequence.store(pos + Capacity, std::memory_order_release);
+            return true;
+        }
+        /// @brief Dequeue every element currently available, up to a maximum, in order.
+        /// @param out Vector to append dequeued elements to. Its capacity is reused across calls.
+        /// @param max Maximum number of elements to dequeue.
+        /// @return Number of elements dequeued.
+        /// @note Thread-safe. Lock-free.
+        inline size_t tryDequeueBulk(std::vector<T>& out, size_t max = Capacity)
+        {
+            size_t count = 0;
+            T value;
+            while (count < max && this->tryDequeue(value))
+            {
+                out.emplace_back(std::move(value));
+                ++count;
+            }
+            return count;
+        }
+
+        /// @brief Retrieve the approximate number of elements in the queue.
+        /// @return Number of elements in the queue at some point during the call.
+        /// @note Thread-safe.
+        inline size_t sizeApprox() const
+        {
+            size_t enq = this->enqueuePosition.load(std::memory_order_relaxed);
+            size_t deq = this->dequeuePosition.load(std::memory_order_relaxed);
+            return enq > deq ? enq - deq : 0;
+        }
+        /// @brief Retrieve the maximum number of elements the queue can hold.
+        constexpr static size_t capacity()
+        {
+            return Capacity;
+        }
+    };
+} // namespace Firework
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace Firework
+{
+    /// @brief Spin-then-park wait primitive for a single waiting thread.
+    /// `unpark` is sticky: a wake-up that arrives while the owner isn't parked makes its next `park` return immediately, so wake-ups can't be lost.
+    class ThreadParker final
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::mutex lock;
+        std::condition_variable condition;
+        std::atomic<bool> signaled = false;
+        std::atomic<bool> sleeping = false;
+
+        std::atomic<uint64_t> parks = 0;
+        std::atomic<uint64_t> parkedNanoseconds = 0;
+
+        inline bool spinUntil(Clock::time_point until)
+        {
+            while (Clock::now() < until)
+            {
+                if (this->signaled.exchange(false, std::memory_order_acquire))
+                    return true;
+                std::this_thread::yield();
+            }
+            return this->signaled.exchange(false, std::memory_order_acquire);
+        }
+        inline bool sleepUntil(Clock::time_point deadline, bool hasDeadline)
+        {
+            Clock::time_point begin = Clock::now();
+            bool woken;
+            {
+                std::unique_lock guard(this->lock);
+                this->sleeping.store(true, std::memory_order_seq_cst);
+                if (hasDeadline)
+                    woken = this->condition.wait_until(guard, deadline, [this] { return this->signaled.load(std::memory_order_seq_cst); });
+                else
+                {
+                    this->condition.wait(guard, [this] { return this->signaled.load(std::memory_order_seq_cst); });
+                    woken = true;
+                }
+                this->sleeping.store(false, std::memory_order_relaxed);
+            }
+            // Consume the signal with an RMW, so anything published before any coalesced `unpark` is visible.
+            woken = this->signaled.exchange(false, std::memory_order_acq_rel) || woken;
+
+            this->parks.fetch_add(1, std::memory_order_relaxed);
+            this->parkedNanoseconds.fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count()), std::memory_order_relaxed);
+            return woken;
+        }
+    public:
+        ThreadParker() = default;
+        ThreadParker(const ThreadParker&) = delete;
+        ThreadParker(ThreadParker&&) = delete;
+
+        ThreadParker& operator=(const ThreadParker&) = delete;
+        ThreadParker& operator=(ThreadParker&&) = delete;
+
+        /// @brief Block until unparked, spinning for up to `spin` before going to sleep.
+        /// @param spin How long to spin before sleeping. `std::chrono::nanoseconds::max()` busy-waits.
+        /// @note Owning thread only.
+        inline void park(std::chrono::nanoseconds spin)
+        {
+            Clock::time_point now = Clock::now();
+            if (this->spinUntil(spin >= Clock::time_point::max() - now ? Clock::time_point::max() : now + spin))
+                return;
+            (void)this->sleepUntil(Clock::time_point::max(), false);
+        }
+        /// @brief Block until unparked or until a deadline, spinning for up to `spin` before going to sleep.
+        /// @param deadline Point in time to stop waiting at.
+        /// @param spin How long to spin before sleeping. If the deadline is closer than this, the whole wait is spent spinning, for precise wake-ups.
+        /// @return Whether the thread was unparked, rather than reaching the deadline.
+        /// @note Owning thread only.
+        inline bool parkUntil(Clock::time_point deadline, std::chrono::nanoseconds spin)
+        {
+            Clock::time_point now = Clock::now();
+            if (spin >= deadline - now)
+                return this->spinUntil(deadline);
+            if (this->spinUntil(now + spin))
+                return true;
+            return this->sleepUntil(deadline, true);
+        }
+        /// @brief Block until unparked or until a deadline, sleeping for the bulk of the wait and spinning for the final stretch, for precise wake-ups.
+        /// @param deadline Point in time to stop waiting at.
+        /// @param spinThreshold How long before the deadline to stop sleeping and start spinning.
+        /// @return Whether the thread was unparked, rather than reaching the deadline.
+        /// @note Owning thread only.
+        inline bool parkUntilPrecise(Clock::time_point deadline, std::chrono::nanoseconds spinThreshold)
+        {
+            if (Clock::now() < deadline - spinThreshold && this->sleepUntil(deadline - spinThreshold, true))
+                return true;
+            return this->spinUntil(deadline);
+        }
+        /// @brief Block until unparked or until a timeout, spinning for up to `spin` before going to sleep.
+        /// @param timeout Maximum time to wait.
+        /// @param spin How long to spin before sleeping.
+        /// @return Whether the thread was unparked, rather than timing out.
+        /// @note Owning thread only.
+        inline bool parkFor(std::chrono::nanoseconds timeout, std::chrono::nanoseconds spin)
+        {
+            return this->parkUntil(Clock::now() + timeout, spin);
+        }
+
+        /// @brief Wake the owning thread, or make its next park return immediately.
+        /// @note Thread-safe. Only takes a lock if the owner is asleep.
+        inline void unpark()
+        {
+            if (this->signaled.exchange(true, std::memory_order_seq_cst))
+                return;
+            if (this->sleeping.load(std::memory_order_seq_cst))
+            {
+                std::lock_guard guard(this->lock);
+                this->condition.notify_one();
+            }
+        }
+
+        /// @brief Retrieve the number of times the owning thread went to sleep.
+        /// @note Thread-safe.
+        inline uint64_t parkCount() const
+        {
+            return this->parks.load(std::memory_order_relaxed);
+        }
+        /// @brief Retrieve the total time the owning thread has spent asleep.
+        /// @note Thread-safe.
+        inline std::chrono::nanoseconds parkedTime() const
+        {
+            return std::chrono::nanoseconds(this->parkedNanoseconds.load(std::memory_order_relaxed));
+        }
+    };
+} // namespace Firework
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Firework
+{
+    /// @brief Growable Chase-Lev work-stealing deque.
+    /// The owning thread pushes and pops at the bottom, LIFO, any other thread steals from the top, FIFO.
+    /// @tparam T Element type. Must be trivially copyable, typically a pointer.
+    /// @see "Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al., PPoPP '13.
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    class WorkStealingDeque
+    {
+        constexpr static size_t CacheLineSize = 64;
+
+        struct Buffer
+        {
+            size_t capacity;
+            std::unique_ptr<std::atomic<T>[]> data;
+
+            inline explicit Buffer(size_t capacity) : capacity(capacity), data(new std::atomic<T>[capacity])
+            { }
+
+            inline T get(int64_t index) const
+            {
+                return this->data[size_t(index) & (this->capacity - 1)].load(std::memory_order_relaxed);
+            }
+            inline void put(int64_t index, T value)
+            {
+                this->data[size_t(index) & (this->capacity - 1)].store(value, std::memory_order_relaxed);
+            }
+        };
+
+        alignas(CacheLineSize) std::atomic<int64_t> top = 0;
+        alignas(CacheLineSize) std::atomic<int64_t> bottom = 0;
+        alignas(CacheLineSize) std::atomic<Buffer*> buffer;
+        /// @brief Buffers replaced by a grow may still be read by in-progress steals, so they are kept until destruction. Owner only.
+        std::vector<std::unique_ptr<Buffer>> buffers;
+    public:
+        inline explicit WorkStealingDeque(size_t capacity = 1024)
+        {
+            this->buffers.emplace_back(std::make_unique<Buffer>(std::bit_ceil(capacity)));
+            this->buffer.store(this->buffers.back().get(), std::memory_order_relaxed);
+        }
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque(WorkStealingDeque&&) = delete;
+
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+        /// @brief Push an element onto the bottom of the deque.
+        /// @param value Element to push.
+        /// @note Owning thread only.
+        inline void push(T value)
+        {
+            int64_t b = this->bottom.load(std::memory_order_relaxed);
+            int64_t t = this->top.load(std::memory_order_acquire);
+            Buffer* buf = this->buffer.load(std::memory_order_relaxed);
+            if (b - t > int64_t(buf->capacity) - 1)
+            {
+                this->buffers.emplace_back(std::make_unique<Buffer>(buf->capacity * 2));
+                Buffer* grown = this->buffers.back().get();
+                for (int64_t i = t; i < b; i++) grown->put(i, buf->get(i));
+                this->buffer.store(grown, std::memory_order_release);
+                buf = grown;
+            }
+            buf->put(b, value);
+            this->bottom.store(b + 1, std::memory_order_release);
+        }
+        /// @brief Pop the most recently pushed element from the bottom of the deque.
+        /// @param out Popped element.
+        /// @return Whether an element was popped.
+        /// @note Owning thread only.
+        inline bool pop(T& out)
+        {
+            int64_t b = this->bottom.load(std::memory_order_relaxed) - 1;
+            Buffer* buf = this->buffer.load(std::memory_order_relaxed);
+            this->bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = this->top.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                this->bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            out = buf->get(b);
+            if (t == b) // Last element, race any thieves for it.
+            {
+                bool won = this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                this->bottom.store(b + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+        /// @brief Steal the oldest element from the top of the deque.
+        /// @param out Stolen element.
+        /// @return Whether an element was stolen. May spuriously fail under contention.
+        /// @note Thread-safe.
+        inline bool steal(T& out)
+        {
+            int64_t t = this->top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = this->bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return false;
+
+            Buffer* buf = this->buffer.load(std::memory_order_acquire);
+            T value = buf->get(t);
+            if (!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return false;
+            out = value;
+            return true;
+        }
+
+        /// @brief Retrieve whether the deque appeared empty at some point during the call.
+        /// @note Thread-safe.
+        inline bool emptyApprox() const
+        {
+            return this->bottom.load(std::memory_order_relaxed) <= this->top.load(std::memory_order_relaxed);
+        }
+    };
+} // namespace Firework
@@ -0,0 +1,160 @@
+#include "../common.h"
+
+#include <map>
+#include <random>
+
+#include <EntityComponentSystem/Entity.h>
+#include <EntityComponentSystem/EntityManagement.h>
+
+using namespace Firework;
+
+constexpr size_t EntityCounts[] { 1000, 100000, 1000000 };
+// Enough repetitions for a stable median without the largest world taking minutes.
+constexpr size_t repetitionsFor(size_t entities)
+{
+    return entities <= 1000 ? 50 : entities <= 100000 ? 10 : 3;
+}
+// Reparenting moves a subtree within the flat hierarchy, so a bounded number of moves is timed per repetition.
+constexpr size_t ReparentMoves = 1000;
+constexpr size_t ReparentGroups = 16;
+// Attaching an entity updates the subtree size of every ancestor, so building a chain is quadratic in its depth, and the chain is capped to keep that bounded.
+constexpr size_t ChainDepth = 1000;
+
+struct Position
+{
+    float x = 0.0f, y = 0.0f;
+};
+struct Velocity
+{
+    float x = 1.0f, y = 1.0f;
+};
+struct Health
+{
+    int value = 100;
+};
+
+/// @brief Per-phase samples of one world size, in nanoseconds per entity or per operation.
+struct PhaseSamples
+{
+    std::map<std::string, std::vector<double>> samples;
+    std::map<std::string, std::string> units;
+
+    template <typename Func>
+    void time(const std::string& phase, size_t operations, std::string_view unit, Func&& func)
+    {
+        auto begin = BenchmarkClock::now();
+        func();
+        double nanoseconds = std::chrono::duration<double, std::nano>(BenchmarkClock::now() - begin).count();
+        this->samples[phase].push_back(nanoseconds / double(std::max<size_t>(operations, 1)));
+        this->units[phase] = unit;
+    }
+};
+
+static void runRepetition(size_t entityCount, PhaseSamples& phases, std::mt19937& rng)
+{
+    std::vector<EntityHandle> entities;
+    entities.reserve(entityCount);
+
+    phases.time("alloc", entityCount, "ns/entity", [&]
+    {
+        for (size_t i = 0; i < entityCount; i++) entities.emplace_back(Entity::alloc());
+    });
+    phases.time("addComponent", entityCount, "ns/entity", [&]
+    {
+        for (EntityHandle entity : entities) benchmarkDoNotOptimize(entity->addComponent<Position>());
+    });
+    for (EntityHandle entity : entities) entity->addComponent<Velocity>();
+    for (size_t i = 0; i < entityCount; i += 2) entities[i]->addComponent<Health>();
+
+    phases.time("getComponent", entityCount, "ns/entity", [&]
+    {
+        for (EntityHandle entity : entities) benchmarkDoNotOptimize(entity->getComponent<Position>());
+    });
+
+    // The first query of a set of types fills its cache, so it's made before timing, as a running scene would have.
+    Entities::query<Position>();
+    Entities::query<Position, Velocity>();
+    Entities::query<Position, Velocity, Health>();
+    phases.time("forEach/types:1", entityCount, "ns/entity", [&]
+    {
+        Entities::forEach<Position>([](Entity&, Position& position) { benchmarkDoNotOptimize(position.x += 1.0f); });
+    });
+    phases.time("forEach/types:2", entityCount, "ns/entity", [&]
+    {
+        Entities::forEach<Position, Velocity>([](Entity&, Position& position, Velocity& velocity)
+        {
+            position.x += velocity.x;
+            position.y += velocity.y;
+            benchmarkDoNotOptimize(position);
+        });
+    });
+    phases.time("forEach/types:3", entityCount, "ns/entity", [&]
+    {
+        Entities::forEach<Position, Velocity, Health>([](Entity&, Position& position, Velocity& velocity, Health& health)
+        {
+            position.x += velocity.x;
+            health.value -= 1;
+            benchmarkDoNotOptimize(health);
+        });
+    });
+    phases.time("forEachEntity", entityCount, "ns/entity", [&]
+    {
+        Entities::forEachEntity([](Entity& entity) { benchmarkDoNotOptimize(&entity); });
+    });
+    phases.time("removeComponent", (entityCount + 1) / 2, "ns/entity", [&]
+    {
+        for (size_t i = 0; i < entityCount; i += 2) benchmarkDoNotOptimize(entities[i]->removeComponent<Health>());
+    });
+
+    // Groups are never moved themselves, and only ever receive leaves, so no move is rejected as a cycle and every one is timed.
+    size_t moves = std::min(ReparentMoves, entityCount - ReparentGroups);
+    std::uniform_int_distribution<size_t> pickGroup(0, ReparentGroups - 1);
+    std::uniform_int_distribution<size_t> pickEntity(ReparentGroups, entityCount - 1);
+    std::vector<std::pair<EntityHandle, EntityHandle>> plannedMoves;
+    plannedMoves.reserve(moves);
+    for (size_t i = 0; i < moves; i++) plannedMoves.emplace_back(entities[pickEntity(rng)], entities[pickGroup(rng)]);
+    phases.time("reparent", moves, "ns/op", [&]
+    {
+        for (auto [entity, group] : plannedMoves) entity->parent = group;
+    });
+
+    phases.time("destroy", entityCount, "ns/entity", [&] { Entities::destroy(entities); });
+
+    // A single root with every other entity as a direct child, as a screen of many siblings being torn down would be.
+    EntityHandle root = Entity::alloc();
+    phases.time("allocChild/flat", entityCount - 1, "ns/entity", [&]
+    {
+        for (size_t i = 1; i < entityCount; i++) Entity::alloc(root)->addComponent<Position>();
+    });
+    phases.time("clear/flat", entityCount - 1, "ns/entity", [&] { root->clear(); });
+
+    // A chain, each entity the child of the last, for the cost of depth.
+    size_t depth = std::min(ChainDepth, entityCount);
+    phases.time("allocChild/chain:" + std::to_string(ChainDepth), depth - 1, "ns/entity", [&]
+    {
+        EntityHandle parent = root;
+        for (size_t i = 1; i < depth; i++) (parent = Entity::alloc(parent))->addComponent<Position>();
+    });
+    phases.time("clear/chain:" + std::to_string(ChainDepth), depth - 1, "ns/entity", [&] { root->clear(); });
+    root->destroy();
+}
+
+int main(int, char*[])
+{
+    std::mt19937 rng(0x46575345);
+    for (size_t entityCount : EntityCounts)
+    {
+        PhaseSamples phases;
+        for (size_t i = 0; i < repetitionsFor(entityCount); i++) runRepetition(entityCount, phases, rng);
+
+        for (auto& [phase, samples] : phases.samples)
+        {
+            std::string caseName = phase + "/entities:" + std::to_string(entityCount);
+            const std::string& unit = phases.units[phase];
+            benchmarkReport("ECS", caseName, "p50", benchmarkPercentile(samples, 50.0), unit);
+            benchmarkReport("ECS", caseName, "min", samples.front(), unit);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "../common.h"
+
+#include <list>
+#include <memory>
+#include <typeindex>
+
+#include <EntityComponentSystem/EngineEvent.h>
+#include <EntityComponentSystem/Entity.h>
+#include <Library/Event.h>
+
+using namespace Firework;
+using namespace Firework::Internal;
+
+constexpr size_t HandlerCounts[] { 1, 16, 256 };
+constexpr size_t RaisesPerSample = 10000;
+constexpr size_t Samples = 50;
+
+/// @brief How events used to store handlers: one list node each, unsubscribed by searching for the function.
+template <typename... Args>
+struct ListEvent
+{
+    std::list<void (*)(Args...)> children;
+
+    void operator+=(void (*func)(Args...))
+    {
+        this->children.emplace_back(func);
+    }
+    bool operator-=(void (*func)(Args...))
+    {
+        for (auto it = this->children.begin(); it != this->children.end(); ++it)
+        {
+            if (*it == func)
+            {
+                this->children.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+    void operator()(Args... args)
+    {
+        for (auto it = this->children.begin(); it != this->children.end(); ++it) (*it)(args...);
+    }
+};
+
+static uint64_t handled = 0;
+
+static void onTick()
+{
+    ++handled;
+}
+static void onMouseMove(glm::vec2 from)
+{
+    handled += uint64_t(from.x);
+}
+static void onRenderOffloadForComponent(std::type_index, Entity&, std::shared_ptr<void> component, ssz renderIndex)
+{
+    handled += uint64_t(renderIndex) + uint64_t(component != nullptr);
+}
+
+/// @brief Time raising an event with a number of handlers subscribed, in nanoseconds per handler called.
+template <typename EventType, typename Handler, typename... Args>
+static void benchmarkRaise(std::string_view name, Handler handler, Args&&... args)
+{
+    for (size_t handlers : HandlerCounts)
+    {
+        // Handlers are subscribed interleaved with allocations, as they would be over the runtime of a program, so list nodes aren't laid out conveniently.
+        auto event = std::make_unique<EventType>();
+        std::vector<std::unique_ptr<uint8_t[]>> interleaved;
+        for (size_t i = 0; i < handlers; i++)
+        {
+            *event += handler;
+            interleaved.emplace_back(std::make_unique<uint8_t[]>(64));
+        }
+
+        std::vector<double> samples;
+        for (size_t sample = 0; sample < Samples; sample++)
+        {
+            auto begin = BenchmarkClock::now();
+            for (size_t i = 0; i < RaisesPerSample; i++) (*event)(args...);
+            double nanoseconds = std::chrono::duration<double, std::nano>(BenchmarkClock::now() - begin).count();
+            samples.emplace_back(nanoseconds / double(RaisesPerSample * handlers));
+        }
+        benchmarkDoNotOptimize(handled);
+
+        std::string caseName = std::string(name) + "/handlers:" + std::to_string(handlers);
+        benchmarkReport("EventDispatch", caseName, "p50", benchmarkPercentile(samples, 50.0), "ns/handler");
+        benchmarkReport("EventDispatch", caseName, "min", samples.front(), "ns/handler");
+    }
+}
+
+static FuncPtrEvent<> churnEvent;
+static EventHandle churnHandle;
+static void onChurnTick()
+{
+    // Resubscribes itself every raise, which is deferred until the raise finishes.
+    churnEvent -= churnHandle;
+    churnHandle = churnEvent += onChurnTick;
+    ++handled;
+}
+
+int main(int, char*[])
+{
+    Entity& entity = *Entity::alloc();
+    auto component = std::make_shared<int>(0);
+    std::type_index type = typeid(int);
+
+    benchmarkRaise<decltype(EngineEvent::OnTick)>("OnTick", onTick);
+    benchmarkRaise<ListEvent<>>("OnTick/list", onTick);
+    benchmarkRaise<ConcurrentFuncPtrEvent<>>("OnTick/concurrent", onTick);
+    benchmarkRaise<decltype(EngineEvent::OnMouseMove)>("OnMouseMove", onMouseMove, glm::vec2(1.0f, 2.0f));
+    benchmarkRaise<ListEvent<glm::vec2>>("OnMouseMove/list", onMouseMove, glm::vec2(1.0f, 2.0f));
+    benchmarkRaise<decltype(InternalEngineEvent::OnRenderOffloadForComponent)>("OnRenderOffloadForComponent", onRenderOffloadForComponent, type, entity,
+                                                                              component, ssz(1));
+    benchmarkRaise<ListEvent<std::type_index, Entity&, std::shared_ptr<void>, ssz>>("OnRenderOffloadForComponent/list", onRenderOffloadForComponent, type, entity,
+                                                                                    component, ssz(1));
+
+    // Unsubscribing from the middle of the handlers, by handle against searching the list by function.
+    for (size_t handlers : HandlerCounts)
+    {
+        std::vector<double> handleSamples, listSamples;
+        for (size_t sample = 0; sample < Samples; sample++)
+        {
+            FuncPtrEvent<> event;
+            ListEvent<> listEvent;
+            std::vector<EventHandle> handles;
+            for (size_t i = 0; i < handlers; i++)
+            {
+                handles.emplace_back(event += onTick);
+                listEvent += onTick;
+            }
+            listEvent += onChurnTick;
+
+            auto begin = BenchmarkClock::now();
+            for (size_t i = 0; i < RaisesPerSample; i++)
+            {
+                event -= handles[handlers / 2];
+                handles[handlers / 2] = event += onTick;
+            }
+            handleSamples.emplace_back(std::chrono::duration<double, std::nano>(BenchmarkClock::now() - begin).count() / double(RaisesPerSample));
+
+            begin = BenchmarkClock::now();
+            for (size_t i = 0; i < RaisesPerSample; i++)
+            {
+                listEvent -= onChurnTick;
+                listEvent += onChurnTick;
+            }
+            listSamples.emplace_back(std::chrono::duration<double, std::nano>(BenchmarkClock::now() - begin).count() / double(RaisesPerSample));
+        }
+
+        std::string suffix = "/handlers:" + std::to_string(handlers);
+        benchmarkReport("EventDispatch", "resubscribe" + suffix, "p50", benchmarkPercentile(handleSamples, 50.0), "ns/op");
+        benchmarkReport("EventDispatch", "resubscribe/list" + suffix, "p50", benchmarkPercentile(listSamples, 50.0), "ns/op");
+    }
+
+    // A handler resubscribing itself from within the raise, which takes the deferred path every time.
+    {
+        churnHandle = churnEvent += onChurnTick;
+        std::vector<double> samples;
+        for (size_t sample = 0; sample < Samples; sample++)
+        {
+            auto begin = BenchmarkClock::now();
+            for (size_t i = 0; i < RaisesPerSample; i++) churnEvent();
+            samples.emplace_back(std::chrono::duration<double, std::nano>(BenchmarkClock::now() - begin).count() / double(RaisesPerSample));
+        }
+        benchmarkDoNotOptimize(handled);
+        benchmarkReport("EventDispatch", "OnTick/resubscribeWhileRaised", "p50", benchmarkPercentile(samples, 50.0), "ns/raise");
+        churnEvent.clear();
+    }
+
+    entity.destroy();
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "../common.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <Core/RenderJob.h>
+#include <Firework/Config.h>
+#include <Library/RingQueue.h>
+
+using namespace Firework;
+
+constexpr size_t JobsPerProducer = 200000;
+constexpr size_t ProducerCounts[] { 1, 4 };
+constexpr uint32_t JobWorkIterations[] { 0, 256 };
+
+static std::atomic<uint64_t> jobSink = 0;
+
+static void simulateJob(uint32_t iterations)
+{
+    uint64_t acc = 0;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        acc += i * 2654435761u;
+        benchmarkDoNotOptimize(acc);
+    }
+    jobSink.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// @brief The render queue as it was: jobs are popped and run while the queue lock is held.
+struct LegacyRenderQueue
+{
+    std::deque<RenderJob> queue;
+    std::mutex lock;
+
+    template <typename Func>
+    void submit(Func&& job, bool required)
+    {
+        std::lock_guard guard(this->lock);
+        this->queue.emplace_back(std::forward<Func>(job), required);
+    }
+    bool drain()
+    {
+        std::lock_guard guard(this->lock);
+        if (this->queue.empty())
+            return false;
+        while (!this->queue.empty())
+        {
+            RenderJob job = std::move(this->queue.front());
+            this->queue.pop_front();
+            job();
+        }
+        return true;
+    }
+};
+
+/// @brief The render queue as it is now: producers never wait on job execution.
+struct RingRenderQueue
+{
+    RingQueue<RenderJob, Config::RenderQueueCapacity> queue;
+    std::vector<RenderJob> batch;
+
+    template <typename Func>
+    void submit(Func&& job, bool required)
+    {
+        this->queue.emplace(std::forward<Func>(job), required);
+    }
+    bool drain()
+    {
+        if (!this->queue.tryDequeueBulk(this->batch))
+            return false;
+        for (RenderJob& job : this->batch) job();
+        this->batch.clear();
+        return true;
+    }
+};
+
+template <typename Queue>
+static void run(std::string_view name, size_t producers, uint32_t workIterations)
+{
+    Queue queue;
+    std::vector<std::vector<double>> latencies(producers);
+    jobSink = 0;
+
+    const size_t totalJobs = JobsPerProducer * producers;
+    auto begin = BenchmarkClock::now();
+
+    std::thread consumer([&]
+    {
+        while (jobSink.load(std::memory_order_relaxed) < totalJobs)
+        {
+            if (!queue.drain())
+                std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::thread> producerThreads;
+    for (size_t p = 0; p < producers; p++)
+    {
+        producerThreads.emplace_back([&, p]
+        {
+            std::vector<double>& samples = latencies[p];
+            samples.reserve(JobsPerProducer);
+            for (size_t i = 0; i < JobsPerProducer; i++)
+            {
+                auto submitBegin = BenchmarkClock::now();
+                queue.submit([workIterations] { simulateJob(workIterations); }, true);
+                samples.push_back(std::chrono::duration<double, std::nano>(BenchmarkClock::now() - submitBegin).count());
+            }
+        });
+    }
+
+    for (std::thread& thread : producerThreads) thread.join();
+    consumer.join();
+
+    double seconds = std::chrono::duration<double>(BenchmarkClock::now() - begin).count();
+
+    std::vector<double> all;
+    all.reserve(totalJobs);
+    for (auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+
+    std::string caseName = std::string(name) + "/producers:" + std::to_string(producers) + "/work:" + std::to_string(workIterations);
+    benchmarkReport("RenderQueue", caseName, "submit_p50", benchmarkPercentile(all, 50.0), "ns");
+    benchmarkReport("RenderQueue", caseName, "submit_p99", benchmarkPercentile(all, 99.0), "ns");
+    benchmarkReport("RenderQueue", caseName, "submit_max", all.empty() ? 0.0 : all.back(), "ns");
+    benchmarkReport("RenderQueue", caseName, "throughput", double(totalJobs) / seconds, "jobs/s");
+}
+
+int main(int, char*[])
+{
+    for (uint32_t workIterations : JobWorkIterations)
+    {
+        for (size_t producers : ProducerCounts)
+        {
+            run<LegacyRenderQueue>("deque+mutex", producers, workIterations);
+            run<RingRenderQueue>("ring", producers, workIterations);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "../common.h"
+
+#include <atomic>
+#include <thread>
+
+#include <Firework/Config.h>
+#include <Library/RingQueue.h>
+#include <Library/ThreadParker.h>
+
+using namespace Firework;
+
+constexpr size_t Handoffs = 2000;
+constexpr auto HandoffInterval = std::chrono::microseconds(1000);
+constexpr auto IdleDuration = std::chrono::seconds(1);
+
+/// @brief How engine threads used to wait: sleep for a fixed interval, then poll.
+struct SleepPollWaiter
+{
+    void wait()
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(250));
+    }
+    void notify()
+    { }
+};
+/// @brief How engine threads wait now: spin briefly, then park until notified.
+struct ParkWaiter
+{
+    ThreadParker parker;
+
+    void wait()
+    {
+        this->parker.park(Config::ParkSpinDuration);
+    }
+    void notify()
+    {
+        this->parker.unpark();
+    }
+};
+
+template <typename Waiter>
+static void runHandoff(std::string_view name)
+{
+    Waiter waiter;
+    RingQueue<int64_t, 4096> queue;
+    std::atomic<bool> done = false;
+    std::vector<double> latencies;
+    latencies.reserve(Handoffs);
+    double consumerCpuSeconds = 0.0;
+
+    std::thread consumer([&]
+    {
+        double cpuBegin = benchmarkThreadCpuSeconds();
+        int64_t sentAt;
+        while (latencies.size() < Handoffs)
+        {
+            bool any = false;
+            while (queue.tryDequeue(sentAt))
+            {
+                latencies.push_back(double(BenchmarkClock::now().time_since_epoch().count() - sentAt));
+                any = true;
+            }
+            if (!any)
+                waiter.wait();
+        }
+        consumerCpuSeconds = benchmarkThreadCpuSeconds() - cpuBegin;
+    });
+
+    auto begin = BenchmarkClock::now();
+    for (size_t i = 0; i < Handoffs; i++)
+    {
+        std::this_thread::sleep_until(begin + HandoffInterval * i);
+        queue.emplace(int64_t(BenchmarkClock::now().time_since_epoch().count()));
+        waiter.notify();
+    }
+    consumer.join();
+    double wallSeconds = std::chrono::duration<double>(BenchmarkClock::now() - begin).count();
+
+    // Latencies are in clock ticks, convert to nanoseconds.
+    for (double& latency : latencies) latency = latency * double(BenchmarkClock::period::num) * 1e9 / double(BenchmarkClock::period::den);
+
+    benchmarkReport("ThreadHandoff", name, "latency_p50", benchmarkPercentile(latencies, 50.0), "ns");
+    benchmarkReport("ThreadHandoff", name, "latency_p99", benchmarkPercentile(latencies, 99.0), "ns");
+    benchmarkReport("ThreadHandoff", name, "latency_max", latencies.back(), "ns");
+    benchmarkReport("ThreadHandoff", name, "consumer_cpu", consumerCpuSeconds / wallSeconds * 100.0, "%");
+}
+
+template <typename Waiter>
+static void runIdle(std::string_view name)
+{
+    Waiter waiter;
+    std::atomic<bool> done = false;
+    double consumerCpuSeconds = 0.0;
+
+    std::thread consumer([&]
+    {
+        double cpuBegin = benchmarkThreadCpuSeconds();
+        while (!done.load(std::memory_order_acquire)) waiter.wait();
+        consumerCpuSeconds = benchmarkThreadCpuSeconds() - cpuBegin;
+    });
+
+    std::this_thread::sleep_for(IdleDuration);
+    done.store(true, std::memory_order_release);
+    waiter.notify();
+    consumer.join();
+
+    benchmarkReport("ThreadHandoff", name, "idle_cpu", consumerCpuSeconds / std::chrono::duration<double>(IdleDuration).count() * 100.0, "%");
+}
+
+int main(int, char*[])
+{
+    runHandoff<SleepPollWaiter>("sleep-poll");
+    runHandoff<ParkWaiter>("park");
+    runIdle<SleepPollWaiter>("sleep-poll");
+    runIdle<ParkWaiter>("park");
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#if _WIN32
+#define NOMINMAX 1
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+/// @brief Nearest-rank percentile of a set of samples. Sorts `samples`.
+static double benchmarkPercentile(std::vector<double>& samples, double percentile)
+{
+    if (samples.empty())
+        return 0.0;
+
+    std::sort(samples.begin(), samples.end());
+    size_t rank = size_t(percentile / 100.0 * double(samples.size() - 1) + 0.5);
+    return samples[std::min(rank, samples.size() - 1)];
+}
+
+/// @brief Emit one result as a single line of JSON, so runs can be collected and compared over time.
+static void benchmarkReport(std::string_view suite, std::string_view name, std::string_view metric, double value, std::string_view unit)
+{
+    std::printf("{\"suite\":\"%.*s\",\"name\":\"%.*s\",\"metric\":\"%.*s\",\"value\":%.6f,\"unit\":\"%.*s\"}\n", int(suite.size()), suite.data(), int(name.size()), name.data(),
+                int(metric.size()), metric.data(), value, int(unit.size()), unit.data());
+    std::fflush(stdout);
+}
+
+/// @brief Keep the compiler from optimizing away a value.
+template <typename T>
+static void benchmarkDoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/// @brief CPU time consumed by the calling thread so far, in seconds.
+static double benchmarkThreadCpuSeconds()
+{
+#if _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    auto toSeconds = [](FILETIME time) { return double((uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100e-9; };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+#endif
+}
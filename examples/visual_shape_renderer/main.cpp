@@ -38,16 +38,13 @@ int main(int, char*[])
 
         Debug::printHierarchy();
     };
-    InternalEngineEvent::OnLateRenderOffloadForComponent += [](std::type_index type, Entity& entity, std::shared_ptr<void> component, ssz ri)
+    InternalEngineEvent::OnLateRenderOffloadFor(componentID<ShapeRendererTestComponent>()) += [](Entity& entity, void* component, ssz ri)
     {
-        if (type != typeid(ShapeRendererTestComponent))
-            return;
-
-        auto sr = std::static_pointer_cast<ShapeRendererTestComponent>(component);
+        auto sr = static_cast<ShapeRendererTestComponent*>(component);
         if (!sr->rend)
             return;
 
-        CoreEngine::queueRenderJobForFrame([tf = entity.getOrAddComponent<RectTransform>()->matrix(), rend = sr->rend, ri = float(+ri)]
+        CoreEngine::queueRenderJobForFrame([tf = entity.getComponent<RectTransform>()->matrix(), rend = sr->rend, ri = float(+ri)]
         {
             _push_nowarn_c_cast();
 
@@ -60,7 +57,7 @@ int main(int, char*[])
                                         BGFX_STENCIL_TEST_ALWAYS | BGFX_STENCIL_OP_FAIL_S_REPLACE | BGFX_STENCIL_OP_PASS_Z_REPLACE);
 
             _pop_nowarn_c_cast();
-        });
+        }, false);
     };
     EngineEvent::OnKeyHeld += [](Key key)
     {